@@ -83,6 +83,12 @@ int light_val = 150;
 
 #define KEY_SIZE 8192
 
+/*
+ * The number of commands a batch game can ask for without any game time
+ * passing before it is considered to be stuck
+ */
+#define MAX_IDLE_COMMANDS 1000
+
 
 /*
  * An array storing the automaton's additional internal info about the dungeon layout
@@ -95,13 +101,13 @@ int light_val = 150;
  * struct that can store numbers, indices for monsters etc. If it is too hard to get
  * a 2D array of structs to work (I couldn't do it...) then multiple 2D arrays might be best.
  */
-byte (*automaton_map)[MAX_DUNGEON_WID];
+GAME_LOCAL byte (*automaton_map)[MAX_DUNGEON_WID];
 
 int MEMORY = 2;
 // player_type automaton_memory_player[2];   /* storing player info of previous turns */
 // monster_type automaton_memory_monster[2][MON_MAX]; /* storing monster info of previous turns */
 
-byte (automaton_memory_chp)[2]; /* storing chp */
+GAME_LOCAL byte (automaton_memory_chp)[2]; /* storing chp */
 // byte (automaton_memory_posy)[2][250]; /* storing y positions, 0 is player */
 // byte (automaton_memory_posx)[2][250]; /* storing x positions, 0 is player */
 
@@ -109,9 +115,9 @@ byte (automaton_memory_chp)[2]; /* storing chp */
 /*
  * A Queue of keypresses to be sent
  */
-static char *automaton_key_queue;
-static s16b automaton_key_head;
-static s16b automaton_key_tail;
+static GAME_LOCAL char *automaton_key_queue;
+static GAME_LOCAL s16b automaton_key_head;
+static GAME_LOCAL s16b automaton_key_tail;
 
 /*
  * (From the Angband Borg by Ben Harrison & Dr Andrew White)
@@ -206,7 +212,7 @@ void automaton_flush(void)
  * A special function hook (see "util.c") which allows the automaton to take
  * control of the "inkey()" function, and substitute in fake keypresses.
  */
-extern char (*inkey_hack)(int flush_first);
+extern GAME_LOCAL char (*inkey_hack)(int flush_first);
 
 
 /*
@@ -214,6 +220,9 @@ extern char (*inkey_hack)(int flush_first);
  */
 void stop_automaton(void)
 {
+    // nobody can take over a batch game, so it ends here
+    if (arg_batch) automaton_batch_end("stuck");
+
     // set the flag to show the automaton is off
     p_ptr->automaton = FALSE;
 
@@ -228,6 +237,46 @@ void stop_automaton(void)
 }
 
 
+/*
+ * Ends a batch game (see main.c), writing a one line record of how it went
+ * to the standard output and quitting.  Replays of keypress logs end here
+ * too, and the hash of the final state shows whether they matched.
+ *
+ * 'result' is "stuck" or "timeout" if the automaton couldn't carry on, and
+ * NULL if the game came to an end by itself.
+ */
+void automaton_batch_end(cptr result)
+{
+    int i;
+    int kills = 0;
+
+    // work out how the game ended
+    if (!result)
+    {
+        if (p_ptr->escaped)         result = "escaped";
+        else if (p_ptr->is_dead)    result = "died";
+        else                        result = "quit";
+    }
+
+    // count the kills in this life
+    for (i = 1; i < z_info->r_max; i++)
+    {
+        kills += l_list[i].pkills;
+    }
+
+    printf("seed=%lu result=%s depth=%d max_depth=%d turns=%ld player_turns=%ld exp=%ld kills=%d hash=%08lx cause=%s\n",
+           (unsigned long)arg_batch_seed, result, p_ptr->depth, p_ptr->max_depth,
+           (long)turn, (long)playerturn, (long)p_ptr->exp, kills,
+           (unsigned long)state_hash(), p_ptr->is_dead ? p_ptr->died_from : "-");
+    fflush(stdout);
+
+    // finish any keypress log
+    keylog_close();
+
+    quit(NULL);
+}
+
+
 /*
  * Grid distance between two points.
  *
@@ -241,240 +290,157 @@ int grid_distance(int y1, int x1, int y2, int x2)
 
 
 /*
- * Updates an array the size of the map with information about how long the automaton
- * thinks it will take the player to get to the given centre square from any map square.
- * 
- * The code is heavily based on update_flow() from cave.c, so see there for full comments.
+ * Cost hook for the automaton's flows (see flow_fill() in cave.c).
  *
- * This is separated in an attempt to keep as much automaton stuff as possible out of the
- * main game files (and in the hope that the automaton flow code can be tailored in future).
+ * 'data' points to which of the automaton's flows is being built, and 'dist' is
+ * the distance of the grid we are coming from (steps right beside the centre
+ * are treated a little differently).
  */
-void update_automaton_flow(int which_flow, int cy, int cx)
+static int automaton_flow_cost(int y2, int x2, int dist, void *data)
 {
-    /*
-     * int which_flow_a = FLOW_AUTOMATON;
-     * int which_flow_f = FLOW_AUTOMATON_FIGHT;
-     * int which_flow_s = FLOW_AUTOMATON_SECURE;
-     */
+    int which_flow = *((int *) data);
     
-    // paranoia
-    if (!((which_flow == FLOW_AUTOMATON) ||
-          (which_flow == FLOW_AUTOMATON_FIGHT) ||
-          (which_flow == FLOW_AUTOMATON_SECURE)))
+    int cost = 1;
+    int d2;
+    byte y3, x3;
+    
+    bool next_to_wall = FALSE;
+    
+    // secure: when losing health, the square we are standing on blocks the flow
+    // (so nothing is reached by going back through it)
+    if ((which_flow == FLOW_AUTOMATON_SECURE) && (p_ptr->chp < automaton_memory_chp[0]) &&
+        (y2 == p_ptr->py) && (x2 == p_ptr->px))
     {
-        msg_debug("Tried to use update_automaton_flow() not with FLOW_AUTOMATON_XXX.");
-        return;
+        return (0);
     }
     
-    int cost;
+    // skip unknown grids
+    if (!((cave_info[y2][x2] & (CAVE_MARK)) || automaton_map[y2][x2])) return (0);
     
-    int i, d, d2;
-    byte y, x, y2, x2, y3, x3;
-    int last_index;
-    int grid_count = 0;
+    // skip walls
+    if (cave_wall_bold(y2, x2)) return (0);
     
-    /* Note where we get information from, and where we overwrite */
-    int this_cycle = 0;
-    int next_cycle = 1;
+    // skip chasms
+    if (cave_feat[y2][x2] == FEAT_CHASM) return (0);
     
-    byte flow_table[2][2][8 * FLOW_MAX_DIST];
+    // skip rubble
+    if (cave_feat[y2][x2] == FEAT_RUBBLE) return (0);
     
-    /* Save the new flow epicenter */
-    flow_center_y[which_flow] = cy;
-    flow_center_x[which_flow] = cx;
-    update_center_y[which_flow] = cy;
-    update_center_x[which_flow] = cx;
+    // penalise traps
+    if (cave_trap_bold(y2, x2) && !(cave_info[y2][x2] & (CAVE_HIDDEN)))
+    {
+        cost += 3;
+    }
     
-    /* Erase all of the current flow (noise) information */
-    for (y = 0; y < p_ptr->cur_map_hgt; y++)
+    if (cave_m_idx[y2][x2] > 0)
     {
-        for (x = 0; x < p_ptr->cur_map_wid; x++)
+        monster_type *n_ptr = &mon_list[cave_m_idx[y2][x2]];
+        monster_race *q_ptr = &r_info[n_ptr->r_idx];
+        
+        // penalise visible unmoving monsters
+        // except right besides us
+        if ((q_ptr->flags1 & RF1_NEVER_MOVE) && (dist > 0))
         {
-            cave_cost[which_flow][y][x] = FLOW_MAX_DIST;
+            // this brings the cost to lock as target over 12
+            cost += 10;
         }
+        
+        // penalise visible unaware monsters
+        if (n_ptr->alertness < ALERTNESS_ALERT)
+        {
+            cost += 3;
+        }
+        
+        // secure: avoid monsters
+        if (which_flow == FLOW_AUTOMATON_SECURE) cost += 25;
     }
     
-    /*** Update or rebuild the flow ***/
-    
-    /* Store base cost at the character location */
-    cave_cost[which_flow][cy][cx] = 0;
-    
-    /* Store this grid in the flow table, note that we've done so */
-    flow_table[this_cycle][0][0] = cy;
-    flow_table[this_cycle][1][0] = cx;
-    grid_count = 1;
-    
-    /* Extend the noise burst out to its limits */
-    for (cost = 1; cost <= FLOW_MAX_DIST; cost++)
+    // penalise squares next to monsters
+    // penalise squares not next to walls
+    for (d2 = 0; d2 < 8; d2++)
     {
-        /* Get the number of grids we'll be looking at */
-        last_index = grid_count;
-        
-        /* Stop if we've run out of work to do */
-        if (last_index == 0) break;
-        
-        /* Clear the grid count */
-        grid_count = 0;
+        /* Grand-child location */
+        y3 = y2 + ddy_ddd[d2];
+        x3 = x2 + ddx_ddd[d2];
         
-        /* Get each valid entry in the flow table in turn. */
-        for (i = 0; i < last_index; i++)
+        if (cave_m_idx[y3][x3] > 0)
         {
-            /* Get this grid */
-            y = flow_table[this_cycle][0][i];
-            x = flow_table[this_cycle][1][i];
-            
-            // Some grids are not ready to process immediately.
-            // For example doors, which add 5 cost to noise, 3 cost to movement.
-            // They keep getting put back on the queue until ready.
-            if (cave_cost[which_flow][y][x] >= cost)
+            monster_type *n_ptr = &mon_list[cave_m_idx[y3][x3]];
+            monster_race *q_ptr = &r_info[n_ptr->r_idx];
+            
+            // penalise squares next to visible unmoving monsters
+            // except right besides us
+            if ((q_ptr->flags1 & RF1_NEVER_MOVE) && (dist > 0))
             {
-                /* Store this grid in the flow table */
-                flow_table[next_cycle][0][grid_count] = y;
-                flow_table[next_cycle][1][grid_count] = x;
-                
-                /* Increment number of grids stored */
-                grid_count++;
+                cost += 1;
             }
-            // if the grid is ready to process...
-            else
+            
+            // penalise squares next to visible melee monsters
+            if ((n_ptr->ml) && (q_ptr->freq_ranged == 0))
             {
-                /* Look at all adjacent grids */
-                for (d = 0; d < 8; d++)
-                {
-                    int extra_cost = 0;
-                    
-                    bool next_to_wall = FALSE;
-                    
-                    /* Child location */
-                    y2 = y + ddy_ddd[d];
-                    x2 = x + ddx_ddd[d];
-                    
-                    /* Check Bounds */
-                    if (!in_bounds(y2, x2)) continue;
-                    
-                    /* Ignore previously marked grids, unless this is a shorter distance */
-                    if (cave_cost[which_flow][y2][x2] < FLOW_MAX_DIST) continue;
-                    
-                    // skip unknown grids
-                    if (!((cave_info[y2][x2] & (CAVE_MARK)) || automaton_map[y2][x2])) continue;
-                    
-                    // skip walls
-                    if (cave_wall_bold(y2, x2)) continue;
-                    
-                    // skip chasms
-                    if (cave_feat[y2][x2] == FEAT_CHASM) continue;
-                    
-                    // skip rubble
-                    if (cave_feat[y2][x2] == FEAT_RUBBLE) continue;
-                    
-                    // penalise traps
-                    if (cave_trap_bold(y2, x2) && !(cave_info[y2][x2] & (CAVE_HIDDEN)))
-                    {
-                        extra_cost += 3;
-                    }
-                    
-                    if (cave_m_idx[y2][x2] > 0)
-                    {
-                        monster_type *n_ptr = &mon_list[cave_m_idx[y2][x2]];
-                        monster_race *q_ptr = &r_info[n_ptr->r_idx];
-                        
-                        // penalise visible unmoving monsters
-                        // except right besides us
-                        if ((q_ptr->flags1 & RF1_NEVER_MOVE) && (cost > 1))
-                        {
-                            // this brings the cost to lock as target over 12
-                            extra_cost += 10;
-                        }
-                        
-                        // penalise visible unaware monsters
-                        if (n_ptr->alertness < ALERTNESS_ALERT)
-                        {
-                            extra_cost += 3;
-                        }
-                        
-                        // secure: avoid monsters
-                        if (which_flow == FLOW_AUTOMATON_SECURE) extra_cost += 25;
-                    }
-                    
-                    // penalise squares next to monsters
-                    // penalise squares not next to walls
-                    for (d2 = 0; d2 < 8; d2++)
-                    {
-                        /* Grand-child location */
-                        y3 = y2 + ddy_ddd[d2];
-                        x3 = x2 + ddx_ddd[d2];
-                        
-                        if (cave_m_idx[y3][x3] > 0)
-                        {
-                            monster_type *n_ptr = &mon_list[cave_m_idx[y3][x3]];
-                            monster_race *q_ptr = &r_info[n_ptr->r_idx];
-                            
-                            // penalise squares next to visible unmoving monsters
-                            // except right besides us
-                            if ((q_ptr->flags1 & RF1_NEVER_MOVE) && (cost > 1))
-                            {
-                                extra_cost += 1;
-                            }
-                            
-                            // penalise squares next to visible melee monsters
-                            if ((n_ptr->ml) && (q_ptr->freq_ranged == 0))
-                            {
-                                extra_cost += 2;
-                            }
-                            
-                            // penalise squares for each visible unalert monsters next to it
-                            if ((n_ptr->ml) && (n_ptr->alertness < ALERTNESS_ALERT))
-                            {
-                                extra_cost += 1;
-                            }
-                            
-                            // secure: avoid monsters
-                            if (which_flow == FLOW_AUTOMATON_SECURE) extra_cost += 2;
-                        }
-                        
-                        if (cave_wall_bold(y3, x3))
-                        {
-                            next_to_wall = TRUE;
-                        }
-                    }
-                    
-                    // penalise squares not next to walls
-                    // but only if there is no monster on it where we are standing right beside it
-                    if ((!next_to_wall) && (cave_m_idx[y2][x2] == 0) && (cost > 1))
-                    {
-                        extra_cost += 1;
-                    }
-                    
-                    /* Store cost at this location */
-                    cave_cost[which_flow][y2][x2] = cost + extra_cost;
-                    
-                    /* Store this grid in the flow table */
-                    flow_table[next_cycle][0][grid_count] = y2;
-                    flow_table[next_cycle][1][grid_count] = x2;
-                    
-                    /* Increment number of grids stored */
-                    grid_count++;
-                }
+                cost += 2;
             }
+            
+            // penalise squares for each visible unalert monsters next to it
+            if ((n_ptr->ml) && (n_ptr->alertness < ALERTNESS_ALERT))
+            {
+                cost += 1;
+            }
+            
+            // secure: avoid monsters
+            if (which_flow == FLOW_AUTOMATON_SECURE) cost += 2;
         }
         
-        if ((which_flow == FLOW_AUTOMATON_SECURE) && (p_ptr->chp < automaton_memory_chp[0]))
-        {
-            cave_cost[which_flow][p_ptr->py][p_ptr->px] += 1;
-        }
-        
-        /* Swap write and read portions of the table */
-        if (this_cycle == 0)
-        {
-            this_cycle = 1;
-            next_cycle = 0;
-        }
-        else
+        if (cave_wall_bold(y3, x3))
         {
-            this_cycle = 0;
-            next_cycle = 1;
+            next_to_wall = TRUE;
         }
     }
+    
+    // penalise squares not next to walls
+    // but only if there is no monster on it where we are standing right beside it
+    if ((!next_to_wall) && (cave_m_idx[y2][x2] == 0) && (dist > 0))
+    {
+        cost += 1;
+    }
+    
+    return (cost);
+}
+
+
+/*
+ * Updates an array the size of the map with information about how long the automaton
+ * thinks it will take the player to get to the given centre square from any map square.
+ * 
+ * The flow itself is built by flow_fill() from cave.c, with the automaton's own costs.
+ *
+ * This is separated in an attempt to keep as much automaton stuff as possible out of the
+ * main game files (and in the hope that the automaton flow code can be tailored in future).
+ */
+void update_automaton_flow(int which_flow, int cy, int cx)
+{
+    int max_dist;
+    
+    // paranoia
+    if (!((which_flow == FLOW_AUTOMATON) ||
+          (which_flow == FLOW_AUTOMATON_FIGHT) ||
+          (which_flow == FLOW_AUTOMATON_SECURE)))
+    {
+        msg_debug("Tried to use update_automaton_flow() not with FLOW_AUTOMATON_XXX.");
+        return;
+    }
+    
+    max_dist = flow_fill(which_flow, cy, cx, automaton_flow_cost, &which_flow);
+    
+    // secure: staying put is worse when losing health
+    // (the player's square gets one extra point for each step the flow spread out,
+    //  when it is the centre; otherwise automaton_flow_cost() has left it unreached)
+    if ((which_flow == FLOW_AUTOMATON_SECURE) && (p_ptr->chp < automaton_memory_chp[0]) &&
+        (cave_cost[which_flow][p_ptr->py][p_ptr->px] < FLOW_MAX_DIST))
+    {
+        cave_cost[which_flow][p_ptr->py][p_ptr->px] =
+            MIN(cave_cost[which_flow][p_ptr->py][p_ptr->px] + max_dist + 1, FLOW_MAX_DIST);
+    }
 }
 
 
@@ -1585,12 +1551,78 @@ bool renew_light(void)
 }
 
 
-void rest(int *ty, int *tx)
+/*
+ * Work out how many turns of rest can be left to the game's own rest command,
+ * rather than being decided one turn at a time.  Returns 0 if they can't.
+ *
+ * Health comes back at a known rate (see regen_turns()), the timed effects
+ * wear off a point a turn, and food and light are used up at known rates, so
+ * the first turn at which the automaton would want to do something else can
+ * be worked out in advance.  Anything that can't (a wandering monster turning
+ * up, or a monster noticing us) disturbs the rest and hands control back.
+ */
+static int rest_turns(void)
+{
+    int i;
+    int turns;
+    int rate;
+    int regen_multiplier = player_regen_multiplier();
+    object_type *o_ptr = &inventory[INVEN_LITE];
+    
+    // only when there is nobody around to keep an eye on
+    for (i = 1; i < mon_max; i++)
+    {
+        if (mon_list[i].r_idx && mon_list[i].ml) return (0);
+    }
+    
+    // poison and cuts stop healing and do damage, and fear needn't wear off
+    if (p_ptr->poisoned || p_ptr->cut || p_ptr->afraid) return (0);
+    
+    // nothing to wait for if health isn't coming back (e.g. when starving)
+    if (regen_multiplier == 0) return (0);
+    
+    // turns until back above 75% health
+    turns = regen_turns(playerturn, p_ptr->mhp, PY_REGEN_HP_PERIOD / regen_multiplier,
+                        (p_ptr->mhp * 75 + 99) / 100 - p_ptr->chp);
+    
+    // turns until the timed effects have worn off
+    turns = MAX(turns, p_ptr->stun);
+    turns = MAX(turns, p_ptr->confused);
+    turns = MAX(turns, p_ptr->blind);
+    turns = MAX(turns, p_ptr->image);
+    turns = MAX(turns, p_ptr->slow);
+    
+    // stop before getting hungry
+    if (p_ptr->food >= 2000)
+    {
+        rate = (p_ptr->hunger > 0) ? int_exp(3, p_ptr->hunger) : 1;
+        if (p_ptr->food >= PY_FOOD_MAX) rate *= 9;
+        
+        turns = MIN(turns, (p_ptr->food - 2000) / rate);
+    }
+    
+    // stop before the light needs renewing
+    if ((o_ptr->sval == SV_LIGHT_TORCH) || (o_ptr->sval == SV_LIGHT_LANTERN))
+    {
+        turns = MIN(turns, o_ptr->timeout - 110);
+    }
+    
+    // a single turn is as easily taken by hand
+    if (turns < 2) return (0);
+    
+    return (MIN(turns, 9999));
+}
+
+
+bool rest(int *ty, int *tx)
 {
+    int turns;
+    char commands[80];
+    
     // if we are not poisoned but still lost health during this turn
     if ((!p_ptr->poisoned) && (automaton_memory_chp[0] > p_ptr->chp))
     {
-        return;
+        return (FALSE);
     }
     
     /* only rest if no health is lost from previous turn to now */
@@ -1599,9 +1631,25 @@ void rest(int *ty, int *tx)
         (p_ptr->blind) || (p_ptr->image) || (p_ptr->slow) || (p_ptr->cut) ||
         (p_ptr->poisoned))
     {
+        turns = rest_turns();
+        
+        // rest for a while with the rest command (bypassing any keymap)
+        if (turns)
+        {
+            // create the commands
+            strnfmt(commands, sizeof(commands), "%c%d\n\\Z", angband_keyset ? '0' : 'R', turns);
+            
+            // queue the commands
+            automaton_keypresses(commands);
+            
+            return (TRUE);
+        }
+        
         *ty = p_ptr->py;
         *tx = p_ptr->px;
     }
+    
+    return (FALSE);
 }
 
 
@@ -1999,7 +2047,7 @@ void automaton_turn(void)
     // if (ty == 0)    if (renew_arrows())  return;
 
     // otherwise: rest if less than 75% health or with negative timed effects
-    if (ty == 0)    rest(&ty, &tx);
+    if (ty == 0)    if (rest(&ty, &tx))  return;
     
     // otherwise: eat something from inventory if hungry
     if (ty == 0)    if (eat_food())  return;
@@ -2198,6 +2246,7 @@ char automaton_inkey_hack(int flush_first)
 {
 	int i;
     char ch;
+    u16b old_stream;
     
 	// paranoia
 	if (!p_ptr->automaton)
@@ -2238,13 +2287,42 @@ char automaton_inkey_hack(int flush_first)
         // handle waiting for commands separately
         if (waiting_for_command)
         {
+            // batch games stop at their turn limit, or if they stop using any time
+            if (arg_batch)
+            {
+                static GAME_LOCAL s32b last_turn = 0;
+                static GAME_LOCAL int idle_commands = 0;
+
+                if (turn >= arg_batch_turns) automaton_batch_end("timeout");
+
+                if (turn != last_turn)
+                {
+                    last_turn = turn;
+                    idle_commands = 0;
+                }
+                else if (++idle_commands > MAX_IDLE_COMMANDS)
+                {
+                    automaton_batch_end("stuck");
+                }
+            }
+
             // takes its turn by choosing some keys representing commands and queuing them
+            // (using its own random numbers, so it doesn't disturb the game's)
+            old_stream = Rand_stream;
+            Rand_stream = RAND_STREAM_AUTOMATON;
             automaton_turn();
+            Rand_stream = old_stream;
             
             // pause for a moment so the user can see what is happening
-            Term_xtra(TERM_XTRA_DELAY, OPT_delay_factor_auto * op_ptr->delay_factor);
+            if (!arg_batch) Term_xtra(TERM_XTRA_DELAY, OPT_delay_factor_auto * op_ptr->delay_factor);
         }
         
+        // the game is only checking for a key to interrupt a rest
+        else if (inkey_scan)
+        {
+            return ('\0');
+        }
+
         else
         {
             /* Hack -- Process events (do not wait) */
@@ -592,6 +592,9 @@ static void player_wipe(void)
 		l_ptr->pkills = 0;
 	}
 
+	/* The monster allocation table is out of date */
+	alloc_race_version++;
+
 	/*No current player ghosts*/
 	bones_selector = 0;
 
@@ -1343,6 +1346,68 @@ static bool get_player_house(void)
 }
 
 
+/*
+ * Helper function for 'player_birth_aux_1()' and 'player_birth_batch()'.
+ *
+ * Clears the skills and abilities, and sets up the options and squelching
+ * for a new character.
+ */
+static void player_birth_reset(void)
+{
+	int i, j;
+
+	/* Clear the base values of the skills */
+	for (i = 0; i < A_MAX; i++) p_ptr->skill_base[i] = 0;
+
+	/* Clear the abilities */
+	for (i = 0; i < S_MAX; i++)
+	{
+		for (j = 0; j < ABILITIES_MAX; j++)
+		{
+			p_ptr->innate_ability[i][j] = FALSE;
+			p_ptr->active_ability[i][j] = FALSE;
+		}
+	}
+	
+	/* Set adult options from birth options */
+	for (i = OPT_BIRTH; i < OPT_CHEAT; i++)
+	{
+		op_ptr->opt[OPT_ADULT + (i - OPT_BIRTH)] = op_ptr->opt[i];
+	}
+
+	/* Reset score options from cheat options */
+	for (i = OPT_CHEAT; i < OPT_ADULT; i++)
+	{
+		op_ptr->opt[OPT_SCORE + (i - OPT_CHEAT)] = op_ptr->opt[i];
+	}
+
+	// Set a default value for hitpoint warning / delay factor unless this is an old game file
+	if (strlen(op_ptr->full_name) == 0)
+	{
+		op_ptr->hitpoint_warn = 3;
+		op_ptr->delay_factor = 5;
+	}
+	
+	/* reset squelch bits */
+
+	for (i = 0; i < z_info->k_max; i++)
+	{
+		k_info[i].squelch = SQUELCH_NEVER;
+	}
+	/*Clear the squelch bytes*/
+	for (i = 0; i < SQUELCH_BYTES; i++)
+	{
+		squelch_level[i] = SQUELCH_NONE;
+	}
+	/* Clear the special item squelching flags */
+	for (i = 0; i < z_info->e_max; i++)
+	{
+		e_info[i].aware = FALSE;
+		e_info[i].squelch = FALSE;
+	}
+}
+
+
 /*
  * Helper function for 'player_birth()'.
  *
@@ -1351,8 +1416,6 @@ static bool get_player_house(void)
  */
 static bool player_birth_aux_1(void)
 {
-	int i, j;
-
 	int phase = 1;
 
 	/*** Instructions ***/
@@ -1428,55 +1491,8 @@ static bool player_birth_aux_1(void)
 	
 	}
 
-	/* Clear the base values of the skills */
-	for (i = 0; i < A_MAX; i++) p_ptr->skill_base[i] = 0;
-
-	/* Clear the abilities */
-	for (i = 0; i < S_MAX; i++)
-	{
-		for (j = 0; j < ABILITIES_MAX; j++)
-		{
-			p_ptr->innate_ability[i][j] = FALSE;
-			p_ptr->active_ability[i][j] = FALSE;
-		}
-	}
-	
-	/* Set adult options from birth options */
-	for (i = OPT_BIRTH; i < OPT_CHEAT; i++)
-	{
-		op_ptr->opt[OPT_ADULT + (i - OPT_BIRTH)] = op_ptr->opt[i];
-	}
-
-	/* Reset score options from cheat options */
-	for (i = OPT_CHEAT; i < OPT_ADULT; i++)
-	{
-		op_ptr->opt[OPT_SCORE + (i - OPT_CHEAT)] = op_ptr->opt[i];
-	}
-
-	// Set a default value for hitpoint warning / delay factor unless this is an old game file
-	if (strlen(op_ptr->full_name) == 0)
-	{
-		op_ptr->hitpoint_warn = 3;
-		op_ptr->delay_factor = 5;
-	}
-	
-	/* reset squelch bits */
-
-	for (i = 0; i < z_info->k_max; i++)
-	{
-		k_info[i].squelch = SQUELCH_NEVER;
-	}
-	/*Clear the squelch bytes*/
-	for (i = 0; i < SQUELCH_BYTES; i++)
-	{
-		squelch_level[i] = SQUELCH_NONE;
-	}
-	/* Clear the special item squelching flags */
-	for (i = 0; i < z_info->e_max; i++)
-	{
-		e_info[i].aware = FALSE;
-		e_info[i].squelch = FALSE;
-	}
+	/* Start from a clean slate */
+	player_birth_reset();
 
 	/* Clear */
 	Term_clear();
@@ -1901,6 +1917,114 @@ static bool player_birth_aux(void)
 	return (TRUE);
 }
 
+/*
+ * Helper function for 'player_birth()'.
+ *
+ * Creates the character for a batch game (see main.c) without asking any
+ * questions.  The choices are all made at random, so the character depends
+ * only on the seed of the game, and the starting experience is left for the
+ * automaton to spend.
+ */
+static void player_birth_batch(void)
+{
+	int i, tries;
+	int houses = 0;
+	int house;
+	int cost = 0;
+	int change;
+
+	int stats[A_MAX];
+
+	/* Choose a race */
+	p_ptr->prace = rand_int(z_info->p_max);
+	rp_ptr = &p_info[p_ptr->prace];
+
+	/* Choose a house (some races don't have any) */
+	p_ptr->phouse = 0;
+
+	if (!(rp_ptr->choice & 1))
+	{
+		for (i = 0; i < z_info->c_max; i++)
+		{
+			if (rp_ptr->choice & (1L << i)) houses++;
+		}
+
+		house = rand_int(houses);
+
+		for (i = 0; i < z_info->c_max; i++)
+		{
+			if (!(rp_ptr->choice & (1L << i))) continue;
+
+			if (house-- == 0)
+			{
+				p_ptr->phouse = i;
+				break;
+			}
+		}
+	}
+
+	hp_ptr = &c_info[p_ptr->phouse];
+
+	/* Choose a sex */
+	p_ptr->psex = one_in_(2) ? SEX_FEMALE : SEX_MALE;
+	sp_ptr = &sex_info[p_ptr->psex];
+
+	/* Start from a clean slate */
+	player_birth_reset();
+
+	/* Spend the stat points at random */
+	for (i = 0; i < A_MAX; i++) stats[i] = 0;
+
+	for (tries = 0; tries < 100; tries++)
+	{
+		i = rand_int(A_MAX);
+
+		/* Stay within the table of costs */
+		if (stats[i] + 5 >= (int)N_ELEMENTS(birth_stat_costs)) continue;
+
+		/* Stay within the points available */
+		change = birth_stat_costs[stats[i] + 5] - birth_stat_costs[stats[i] + 4];
+		if (cost + change > MAX_COST) continue;
+
+		stats[i]++;
+		cost += change;
+	}
+
+	/* Apply the racial bonuses */
+	for (i = 0; i < A_MAX; i++)
+	{
+		p_ptr->stat_base[i] = stats[i] + rp_ptr->r_adj[i] + hp_ptr->h_adj[i];
+		p_ptr->stat_drain[i] = 0;
+	}
+
+	/* Determine experience and things */
+	get_extra();
+
+	/* Calculate the bonuses and hitpoints */
+	p_ptr->update |= (PU_BONUS | PU_HP);
+
+	/* Update stuff */
+	update_stuff();
+
+	/* Fully healed */
+	p_ptr->chp = p_ptr->mhp;
+
+	/* Fully rested */
+	calc_voice();
+	p_ptr->csp = p_ptr->msp;
+
+	/* Roll for history and age/height/weight */
+	get_history_aux();
+	get_ahw_aux();
+
+	/* A name */
+	my_strcpy(op_ptr->full_name, "Automaton", sizeof(op_ptr->full_name));
+
+	// Reset the number of artefacts
+	p_ptr->artefacts = 0;
+}
+
+
 /*
  * Create a new character.
  *
@@ -1922,6 +2046,13 @@ void player_birth()
 		/* Wipe the player */
 		player_wipe();
 
+		/* Batch games don't ask any questions */
+		if (arg_batch)
+		{
+			player_birth_batch();
+			break;
+		}
+
 		/* Roll up a new character */
 		if (player_birth_aux()) break;
 	}
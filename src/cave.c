@@ -91,7 +91,7 @@ int distance_squared(int y1, int x1, int y2, int x2)
  * determining which grids are illuminated by the player's torch, and which
  * grids and monsters can be "seen" by the player, etc).
  */
-bool los(int y1, int x1, int y2, int x2)
+static bool los_aux(int y1, int x1, int y2, int x2)
 {
 	/* Delta */
 	int dx, dy;
@@ -332,6 +332,187 @@ void random_unseen_floor(int *ry, int *rx)
 }
 
 
+/*
+ * Cache of the results of "los()"
+ *
+ * A result only depends on the walls between the two grids, so it holds until
+ * the terrain next changes (see "terrain_epoch" and "cave_set_feat()").  Each
+ * result has a slot chosen by hashing its two grids, replacing whatever was
+ * there before.  The key packs the grids into 28 bits (see "LOS_KEY"), and
+ * is followed by a bit for the result.
+ */
+typedef struct los_cache_entry los_cache_entry;
+
+struct los_cache_entry
+{
+	u32b key;		/* Grids, plus the result (LOS_KEY_RESULT), or 0 */
+	u32b epoch;		/* Value of "terrain_epoch" when it was found */
+};
+
+#define LOS_KEY(Y1,X1,Y2,X2) \
+	((((u32b)(Y1) << 22) | ((u32b)(X1) << 14) | ((u32b)(Y2) << 8) | (u32b)(X2)) + 1)
+
+#define LOS_KEY_RESULT	0x10000000L
+
+static GAME_LOCAL los_cache_entry los_cache[LOS_CACHE_SIZE];
+
+
+
+
+/*
+ * Determine if there is a line of sight between two grids (see "los_aux()"),
+ * remembering the answer in case it is asked again.
+ */
+bool los(int y1, int x1, int y2, int x2)
+{
+	los_cache_entry *c_ptr;
+	u32b key;
+	bool result;
+
+	/* Only grids on the map can be cached (the key has room for no more) */
+	if (((unsigned)y1 >= MAX_DUNGEON_HGT) || ((unsigned)x1 >= MAX_DUNGEON_WID) ||
+	    ((unsigned)y2 >= MAX_DUNGEON_HGT) || ((unsigned)x2 >= MAX_DUNGEON_WID))
+	{
+		return (los_aux(y1, x1, y2, x2));
+	}
+
+	PROFILE_COUNT(PROF_LOS_QUERIES);
+
+	key = LOS_KEY(y1, x1, y2, x2);
+	c_ptr = &los_cache[(key * 2654435761UL >> 12) & (LOS_CACHE_SIZE - 1)];
+
+	/* Found it */
+	if (((c_ptr->key & ~LOS_KEY_RESULT) == key) && (c_ptr->epoch == terrain_epoch))
+	{
+		PROFILE_COUNT(PROF_LOS_HITS);
+
+		return ((c_ptr->key & LOS_KEY_RESULT) ? TRUE : FALSE);
+	}
+
+	result = los_aux(y1, x1, y2, x2);
+
+	/* Remember it */
+	c_ptr->key = key | (result ? LOS_KEY_RESULT : 0L);
+	c_ptr->epoch = terrain_epoch;
+
+	return (result);
+}
+
+
+/*
+ * The "player field" -- whether each grid near the player has a line of sight
+ * to the player, and whether the player has one to it.
+ *
+ * Every monster asks these questions about its own grid, often several times
+ * a turn, so each answer is found once and then kept until the player moves or
+ * the terrain changes.  The field covers the grids within "MAX_SIGHT" of the
+ * player (nothing further away can be in sight), and anything outside it is
+ * simply handed to "los()".
+ *
+ * Note that "los()" is not quite symmetric, so the two directions are kept
+ * apart.
+ */
+#define PLAYER_FIELD_WID	(2 * MAX_SIGHT + 1)
+
+#define PF_TO_KNOWN		0x01	/* The "to" bit is known */
+#define PF_TO			0x02	/* The grid has a line of sight to the player */
+#define PF_FROM_KNOWN	0x04	/* The "from" bit is known */
+#define PF_FROM			0x08	/* The player has a line of sight to the grid */
+
+static GAME_LOCAL byte player_field[PLAYER_FIELD_WID][PLAYER_FIELD_WID];
+
+static GAME_LOCAL int player_field_y = -1;
+static GAME_LOCAL int player_field_x = -1;
+static GAME_LOCAL u32b player_field_epoch;
+
+
+/*
+ * Forget every result in the "los()" cache and the player field, when a level
+ * is made or loaded
+ */
+void wipe_los_cache(void)
+{
+	(void)C_WIPE(los_cache, LOS_CACHE_SIZE, los_cache_entry);
+
+	player_field_y = -1;
+	player_field_x = -1;
+}
+
+
+/*
+ * Find the player field entry for a grid, forgetting the whole field first if
+ * the player has moved or the terrain has changed since it was filled in.
+ *
+ * Returns NULL for grids outside the field.
+ */
+static byte *player_field_entry(int y, int x)
+{
+	int py = p_ptr->py;
+	int px = p_ptr->px;
+
+	int dy = y - py + MAX_SIGHT;
+	int dx = x - px + MAX_SIGHT;
+
+	if (((unsigned)dy >= PLAYER_FIELD_WID) || ((unsigned)dx >= PLAYER_FIELD_WID)) return (NULL);
+
+	/* Start again */
+	if ((py != player_field_y) || (px != player_field_x) || (terrain_epoch != player_field_epoch))
+	{
+		(void)C_WIPE(player_field, PLAYER_FIELD_WID, byte[PLAYER_FIELD_WID]);
+
+		player_field_y = py;
+		player_field_x = px;
+		player_field_epoch = terrain_epoch;
+	}
+
+	PROFILE_COUNT(PROF_FIELD_QUERIES);
+
+	return (&player_field[dy][dx]);
+}
+
+
+/*
+ * Determine if a grid has a line of sight to the player,
+ * ie "los(y, x, p_ptr->py, p_ptr->px)".
+ */
+bool los_to_player(int y, int x)
+{
+	byte *f_ptr = player_field_entry(y, x);
+
+	if (!f_ptr) return (los(y, x, p_ptr->py, p_ptr->px));
+
+	if (!(*f_ptr & (PF_TO_KNOWN)))
+	{
+		*f_ptr |= (PF_TO_KNOWN);
+		if (los(y, x, p_ptr->py, p_ptr->px)) *f_ptr |= (PF_TO);
+	}
+	else PROFILE_COUNT(PROF_FIELD_HITS);
+
+	return ((*f_ptr & (PF_TO)) ? TRUE : FALSE);
+}
+
+
+/*
+ * Determine if the player has a line of sight to a grid,
+ * ie "los(p_ptr->py, p_ptr->px, y, x)".
+ */
+bool los_from_player(int y, int x)
+{
+	byte *f_ptr = player_field_entry(y, x);
+
+	if (!f_ptr) return (los(p_ptr->py, p_ptr->px, y, x));
+
+	if (!(*f_ptr & (PF_FROM_KNOWN)))
+	{
+		*f_ptr |= (PF_FROM_KNOWN);
+		if (los(p_ptr->py, p_ptr->px, y, x)) *f_ptr |= (PF_FROM);
+	}
+	else PROFILE_COUNT(PROF_FIELD_HITS);
+
+	return ((*f_ptr & (PF_FROM)) ? TRUE : FALSE);
+}
+
+
 /*
  * Returns true if the player's grid is dark
  */
@@ -2706,6 +2887,62 @@ bool same_side_of_wall_as_player(int y, int x, int fy, int fx)
 }
 
 
+/*
+ * As well as the flags in "cave_info", the view is kept as packed rows of
+ * bits (see "bits_wid"), so that "update_view()" can compare the old and new
+ * views, and the old and new lighting, a whole word of grids at a time.
+ *
+ * These remember which grids were in view, which were lit, and which were
+ * within reach of the player's own light, as of the last update.
+ */
+static GAME_LOCAL bits_wid old_view_bits[MAX_DUNGEON_HGT];
+static GAME_LOCAL bits_wid old_lit_bits[MAX_DUNGEON_HGT];
+static GAME_LOCAL bits_wid old_torch_bits[MAX_DUNGEON_HGT];
+
+/*
+ * These are worked out afresh by each update
+ */
+static GAME_LOCAL bits_wid old_seen_bits[MAX_DUNGEON_HGT];
+static GAME_LOCAL bits_wid view_bits[MAX_DUNGEON_HGT];
+static GAME_LOCAL bits_wid seen_bits[MAX_DUNGEON_HGT];
+static GAME_LOCAL bits_wid lit_bits[MAX_DUNGEON_HGT];
+
+/*
+ * The bit for column X within its word, and setting that bit in row Y
+ */
+#define MAP_BIT(X)			(1UL << ((X) % MAP_WORD_BITS))
+#define map_bit_set(B,Y,X)	((B)[Y][(X) / MAP_WORD_BITS] |= MAP_BIT(X))
+
+
+/*
+ * The position of the lowest bit set in 'w' (which must not be zero)
+ */
+static int lowest_bit(u32b w)
+{
+#ifdef __GNUC__
+	return (__builtin_ctzl(w));
+#else
+	int n = 0;
+
+	while (!(w & 1)) { w >>= 1; n++; }
+
+	return (n);
+#endif
+}
+
+
+/*
+ * Forget the view and lighting of the last update, when a level is made
+ * or loaded, so that nothing on the new level seems to have changed.
+ */
+void wipe_view_history(void)
+{
+	(void)C_WIPE(old_view_bits, MAX_DUNGEON_HGT, bits_wid);
+	(void)C_WIPE(old_lit_bits, MAX_DUNGEON_HGT, bits_wid);
+	(void)C_WIPE(old_torch_bits, MAX_DUNGEON_HGT, bits_wid);
+}
+
+
 /*
  * Calculate the complete field of view using a new algorithm
  *
@@ -2729,9 +2966,10 @@ bool same_side_of_wall_as_player(int y, int x, int fy, int fx)
  * along the diagonal axes, so we check the bits corresponding to
  * the lines of sight near the major axes first.
  *
- * We use the "temp_g" array (and the "CAVE_TEMP" flag) to keep track of
- * which grids were previously marked "CAVE_SEEN", since only those grids
- * whose "CAVE_SEEN" value changes during this routine must be redrawn.
+ * We use the "old_seen_bits" rows to keep track of which grids were
+ * previously marked "CAVE_SEEN", since only those grids whose "CAVE_SEEN"
+ * value changes during this routine must be redrawn, and the changes can
+ * then be found a word at a time.
  *
  * This function is now responsible for maintaining the "CAVE_SEEN"
  * flags as well as the "CAVE_VIEW" flags, which is good, because
@@ -2809,17 +3047,21 @@ void update_view(void)
 	int fast_view_n = view_n;
 	u16b *fast_view_g = view_g;
 
-	int fast_temp_n = 0;
-	u16b *fast_temp_g = temp_g;
-
 	u16b *fast_cave_info = &cave_info[0][0];
 
 	u16b info;
+
+	int w;
+	u32b bits;
 	
 	bool in_pit = cave_pit_bold(p_ptr->py, p_ptr->px) && !p_ptr->leaping;
 
+	PROFILE_START(PROF_UPDATE_VIEW);
+
 	/*** Step 0 -- Begin ***/
 	
+	(void)C_WIPE(old_seen_bits, MAX_DUNGEON_HGT, bits_wid);
+
 	/* Save the old "view" grids for later */
 	for (i = 0; i < fast_view_n; i++)
 	{
@@ -2830,14 +3072,7 @@ void update_view(void)
 		info = fast_cave_info[g];
 
 		/* Save "CAVE_SEEN" grids */
-        if (info & (CAVE_SEEN))
-		{
-			/* Set "CAVE_TEMP" flag */
-			info |= (CAVE_TEMP);
-
-			/* Save grid for later */
-			fast_temp_g[fast_temp_n++] = g;
-		}
+		if (info & (CAVE_SEEN)) map_bit_set(old_seen_bits, GRID_Y(g), GRID_X(g));
 
 		/* Clear "CAVE_VIEW", "CAVE_SEEN" & cave_fire flags */
 		info &= ~(CAVE_VIEW | CAVE_SEEN | CAVE_FIRE);
@@ -3092,11 +3327,23 @@ void update_view(void)
 		}
 	}
 
+	/* Pack the view into rows of bits */
+	(void)C_WIPE(view_bits, MAX_DUNGEON_HGT, bits_wid);
+
+	for (i = 0; i < fast_view_n; i++)
+	{
+		g = fast_view_g[i];
+
+		if (fast_cave_info[g] & (CAVE_VIEW)) map_bit_set(view_bits, GRID_Y(g), GRID_X(g));
+	}
+
 	/*** Step 2b -- handle the Sil-style light ***/
 	
 	/* this is the only step that even looks at these light values */
 
 	// Sil: get the starting light values based on permanent light (and backup old values)
+	(void)C_WIPE(lit_bits, MAX_DUNGEON_HGT, bits_wid);
+
 	for (i = 0; i < MAX_DUNGEON_HGT; i++)
 	{
 		for (j = 0; j < MAX_DUNGEON_WID; j++)
@@ -3104,6 +3351,7 @@ void update_view(void)
 			if (cave_info[i][j] & (CAVE_GLOW))
 			{
 				cave_light[i][j] = 1;
+				map_bit_set(lit_bits, i, j);
 			}
 			else
 			{
@@ -3402,29 +3650,50 @@ void update_view(void)
 		}
 	}
 
-	/* Process "new" grids */
+	/* Pack the seen grids into rows of bits */
+	(void)C_WIPE(seen_bits, MAX_DUNGEON_HGT, bits_wid);
+
 	for (i = 0; i < fast_view_n; i++)
 	{
-		/* Grid */
 		g = fast_view_g[i];
 
-		/* Get grid info */
-		info = fast_cave_info[g];
+		if (fast_cave_info[g] & (CAVE_SEEN)) map_bit_set(seen_bits, GRID_Y(g), GRID_X(g));
+	}
 
-		/* Was not "CAVE_SEEN", is now "CAVE_SEEN" */
-		if ((info & (CAVE_SEEN)) && !(info & (CAVE_TEMP)))
+	/* Only grids in view can have more (or less) light than their own glow */
+	for (i = 0; i < MAX_DUNGEON_HGT; i++)
+	{
+		for (w = 0; w < MAP_WORDS; w++)
 		{
-			int y, x;
+			bits = view_bits[i][w];
 
-			/* Location */
-			y = GRID_Y(g);
-			x = GRID_X(g);
+			lit_bits[i][w] &= ~bits;
+
+			for (; bits; bits &= bits - 1)
+			{
+				j = w * MAP_WORD_BITS + lowest_bit(bits);
+
+				if (cave_light[i][j] > 0) map_bit_set(lit_bits, i, j);
+			}
+		}
+	}
+
+	/* Process "new" grids */
+	for (i = 0; i < MAX_DUNGEON_HGT; i++)
+	{
+		for (w = 0; w < MAP_WORDS; w++)
+		{
+			/* Was not "CAVE_SEEN", is now "CAVE_SEEN" */
+			for (bits = seen_bits[i][w] & ~old_seen_bits[i][w]; bits; bits &= bits - 1)
+			{
+				j = w * MAP_WORD_BITS + lowest_bit(bits);
 
-			/* Note */
-			note_spot(y, x);
+				/* Note */
+				note_spot(i, j);
 
-			/* Redraw */
-			lite_spot(y, x);
+				/* Redraw */
+				lite_spot(i, j);
+			}
 		}
 	}
 
@@ -3442,86 +3711,80 @@ void update_view(void)
 	}
 	
 	/* Process "old" grids */
-	for (i = 0; i < fast_temp_n; i++)
+	for (i = 0; i < MAX_DUNGEON_HGT; i++)
 	{
-		/* Grid */
-		g = fast_temp_g[i];
-
-		/* Get grid info */
-		info = fast_cave_info[g];
-
-		/* Clear "CAVE_TEMP" flag */
-		info &= ~(CAVE_TEMP);
-
-		/* Save cave info */
-		fast_cave_info[g] = info;
-
-		/* Was "CAVE_SEEN", is now not "CAVE_SEEN" */
-		if (!(info & (CAVE_SEEN)))
+		for (w = 0; w < MAP_WORDS; w++)
 		{
-			int y, x;
-
-			/* Location */
-			y = GRID_Y(g);
-			x = GRID_X(g);
-
-			/* Redraw */
-			lite_spot(y, x);
+			/* Was "CAVE_SEEN", is now not "CAVE_SEEN" */
+			for (bits = old_seen_bits[i][w] & ~seen_bits[i][w]; bits; bits &= bits - 1)
+			{
+				/* Redraw */
+				lite_spot(i, w * MAP_WORD_BITS + lowest_bit(bits));
+			}
 		}
 	}
 
 	// Sil: this is needed to properly darken certain spots
 	for (i = 0; i < MAX_DUNGEON_HGT; i++)
 	{
-		for (j = 0; j < MAX_DUNGEON_WID; j++)
+		for (w = 0; w < MAP_WORDS; w++)
 		{
-			if ((cave_info[i][j] & (CAVE_GLOW)) && (cave_info[i][j] & (CAVE_VIEW)) && 
-			    !(cave_info[i][j] & (CAVE_SEEN)))
+			for (bits = view_bits[i][w] & ~seen_bits[i][w]; bits; bits &= bits - 1)
 			{
-				/* Redraw */
-				lite_spot(i, j);
+				j = w * MAP_WORD_BITS + lowest_bit(bits);
+
+				if (cave_info[i][j] & (CAVE_GLOW))
+				{
+					/* Redraw */
+					lite_spot(i, j);
+				}
 			}
 		}
 	}
 
 	// Sil: disturb the player when the lighting changes unexpectedly
-	for (i = py - MAX_SIGHT; i <= py + MAX_SIGHT; i++)
+	//      (only grids that were in view and still are, and whose light changed)
+	for (i = MAX(py - MAX_SIGHT, 0); i <= MIN(py + MAX_SIGHT, MAX_DUNGEON_HGT - 1); i++)
 	{
-		for (j = px - MAX_SIGHT; j <= px + MAX_SIGHT; j++)
+		for (w = 0; w < MAP_WORDS; w++)
 		{
-			if (in_bounds_fully(i,j) && ((i != py) || (j != px)))
+			bits = old_view_bits[i][w] & view_bits[i][w] & (old_lit_bits[i][w] ^ lit_bits[i][w]);
+
+			for (; bits; bits &= bits - 1)
 			{
-				info = cave_info[i][j];
-				
-				if ((info & (CAVE_OLD_VIEW)) && (info & (CAVE_VIEW)))
+				int b = lowest_bit(bits);
+				bool old_torch = (old_torch_bits[i][w] & MAP_BIT(b)) ? TRUE : FALSE;
+
+				j = w * MAP_WORD_BITS + b;
+
+				if ((ABS(j - px) > MAX_SIGHT) || !in_bounds_fully(i,j) || ((i == py) && (j == px))) continue;
+
+				// check recently darkened squares
+				if (old_lit_bits[i][w] & MAP_BIT(b))
 				{
-					// check recently darkened squares
-					if ((info & (CAVE_OLD_LIT)) && (cave_light[i][j] <= 0))
+					// if they didn't just fall out of torch radius
+					if (!(old_torch && (distance(py, px, i, j) > player_rad)))
 					{
-						// if they didn't just fall out of torch radius
-						if (!((info & (CAVE_OLD_TORCH)) && (distance(py, px, i, j) > player_rad)))
+						// ignore in some negative light situations (not a perfect fix, but good enough)
+						if ((p_ptr->old_light >= 0) || (distance(py, px, i, j) > player_rad + 1))
 						{
-							// ignore in some negative light situations (not a perfect fix, but good enough)
-							if ((p_ptr->old_light >= 0) || (distance(py, px, i, j) > player_rad + 1))
-							{
-								disturb(0, 0);
-								//msg_format("(%d,%d) Disturbed on loss of light.",i,j);
-							}
+							disturb(0, 0);
+							//msg_format("(%d,%d) Disturbed on loss of light.",i,j);
 						}
 					}
-					
-					// check recently lit squares
-					if (!(info & (CAVE_OLD_LIT)) && (cave_light[i][j] > 0))
+				}
+				
+				// check recently lit squares
+				else
+				{
+					// if they didn't just enter torch radius
+					if (!(!old_torch && (distance(py, px, i, j) <= player_rad)))
 					{
-						// if they didn't just enter torch radius
-						if (!(!(info & (CAVE_OLD_TORCH)) && (distance(py, px, i, j) <= player_rad)))
+						// ignore in some negative light situations (not a perfect fix, but good enough)
+						if ((p_ptr->old_light >= 0) || (distance(py, px, i, j) > player_rad + 1))
 						{
-							// ignore in some negative light situations (not a perfect fix, but good enough)
-							if ((p_ptr->old_light >= 0) || (distance(py, px, i, j) > player_rad + 1))
-							{
-								disturb(0, 0);
-								//msg_format("(%d,%d) Disturbed on gain of light.",i,j);
-							}
+							disturb(0, 0);
+							//msg_format("(%d,%d) Disturbed on gain of light.",i,j);
 						}
 					}
 				}
@@ -3532,44 +3795,27 @@ void update_view(void)
 	// Sil: record information about view and lighting for next call to update_view()
 	//      so that they player can be disturbed when lighting changes unexpectedly
 	p_ptr->old_light = p_ptr->cur_light;
-	for (i = 0; i < MAX_DUNGEON_HGT; i++)
+
+	(void)C_COPY(old_view_bits, view_bits, MAX_DUNGEON_HGT, bits_wid);
+	(void)C_COPY(old_lit_bits, lit_bits, MAX_DUNGEON_HGT, bits_wid);
+
+	// store 'torchlight' information for last turn
+	(void)C_WIPE(old_torch_bits, MAX_DUNGEON_HGT, bits_wid);
+
+	for (i = py - p_ptr->old_light; i <= py + p_ptr->old_light; i++)
 	{
-		for (j = 0; j < MAX_DUNGEON_WID; j++)
-		{		
-			// store view information for last turn
-			if (cave_info[i][j] & (CAVE_VIEW))
-			{
-				cave_info[i][j] |= (CAVE_OLD_VIEW);
-			}
-			else
-			{
-				cave_info[i][j] &= ~(CAVE_OLD_VIEW);
-			}
-			
-			// store lighting information for last turn
-			if (cave_light[i][j] > 0)
-			{
-				cave_info[i][j] |= (CAVE_OLD_LIT);
-			}
-			else
-			{
-				cave_info[i][j] &= ~(CAVE_OLD_LIT);
-			}
-			
-			// store 'torchlight' information for last turn
-			if (distance(py, px, i, j) <= p_ptr->old_light)
-			{
-				cave_info[i][j] |= (CAVE_OLD_TORCH);
-			}
-			else
-			{
-				cave_info[i][j] &= ~(CAVE_OLD_TORCH);
-			}
+		for (j = px - p_ptr->old_light; j <= px + p_ptr->old_light; j++)
+		{
+			if ((i < 0) || (i >= MAX_DUNGEON_HGT) || (j < 0) || (j >= MAX_DUNGEON_WID)) continue;
+
+			if (distance(py, px, i, j) <= p_ptr->old_light) map_bit_set(old_torch_bits, i, j);
 		}
 	}
 	
 	/* Save 'view_n' */
 	view_n = fast_view_n;
+
+	PROFILE_STOP(PROF_UPDATE_VIEW);
 }
 
 /*
@@ -3582,6 +3828,9 @@ int flow_dist(int which_flow, int y, int x)
 {
 	int dist;
 	
+	/* Flows that haven't been built reach nowhere */
+	if (!cave_cost[which_flow]) return (FLOW_MAX_DIST);
+
 	dist = cave_cost[which_flow][y][x];
 		
 	return (dist);
@@ -3595,250 +3844,792 @@ int flow_dist(int which_flow, int y, int x)
  * One of these flows is used to represent the from the player noise at each location.
  * Another is used to represent the noise from a particular monster.
  *
- * 200 of them are used for alert monster pathfinding, representing the shortest route
- * each monster could take to get to the player.
+ * 300 of them are used for alert monster pathfinding, representing the shortest route
+ * monsters of each movement class could take to get to the player (see update_monster_flow()).
  *
  * 100 of them are used for the pathfinding of unwary monsters who move in their
  * initial groups to various locations around the map.
  *
- * There is an intermediate data-structure called the flow table, which is 3-dimensional.
- * The first dimension allows the
- * table to both store and overwrite grids safely.  The second indicates
- * whether this value is that for x or for y.  The third is the number
- * of grids able to be stored at any flow distance.
+ * The last few are used by the automaton (see update_automaton_flow()).
  *
- * Note that the noise is generated around the centre cy, cx
- * This is often the player, but can be a monster (for FLOW_MONSTER_NOISE)
+ * All of them are built by the same code (flow_fill()), which spreads outwards from
+ * a centre, with a 'cost hook' that says how much it costs to enter each grid.
+ * This is usually one, but can be more for doors, traps, tunnelling and the like.
+ */
+
+
+/*
+ * A bucket queue of grids, ordered by flow distance.
  *
+ * There is a bucket for each distance from 0 to FLOW_MAX_DIST - 1, and each
+ * bucket is a doubly linked list threaded through the grids, so that a grid
+ * can be moved to a nearer bucket in constant time when a shorter route to
+ * it is found.  Grids are referred to by FLOW_GRID(y, x).
+ *
+ * As the costs of entering grids are bounded, this gives Dijkstra's algorithm
+ * in linear time (Dial's algorithm), and the queue can never overflow.
  */
+#define FLOW_GRIDS    (MAX_DUNGEON_HGT * MAX_DUNGEON_WID)
+#define FLOW_NO_GRID  0xFFFF
 
-void update_flow(int cy, int cx, int which_flow)
-{
-	int cost;
+static GAME_LOCAL u16b flow_bucket[FLOW_MAX_DIST];
+static GAME_LOCAL u16b flow_next[FLOW_GRIDS];
+static GAME_LOCAL u16b flow_prev[FLOW_GRIDS];
+static GAME_LOCAL byte flow_key[FLOW_GRIDS];
+static GAME_LOCAL bool flow_queued[FLOW_GRIDS];
+static GAME_LOCAL int flow_queue_min;
 
-	int i, d;
-	byte y, x, y2, x2;
-	int last_index;
-	int grid_count = 0;
+/*
+ * Grids affected by the terrain changes (marked with the current stamp)
+ */
+static GAME_LOCAL u16b flow_mark[FLOW_GRIDS];
+static GAME_LOCAL u16b flow_stamp = 0;
+static GAME_LOCAL u16b flow_list[FLOW_GRIDS];
 
-	/* Note where we get information from, and where we overwrite */
-	int this_cycle = 0;
-	int next_cycle = 1;
-    
-    bool monster_flow = FALSE;
-    bool bash = FALSE;
-    bool found = FALSE;
-    
-    monster_type *m_ptr = NULL; // default to soothe compiler warnings
-    monster_race *r_ptr = NULL; // default to soothe compiler warnings
 
-	byte flow_table[2][2][8 * FLOW_MAX_DIST];
+static void flow_queue_wipe(void)
+{
+	int i;
 
-    // paranoia
-    if (which_flow == FLOW_AUTOMATON)
-    {
-        msg_debug("Tried to use update_flow() with FLOW_AUTOMATON.");
-        return;
-    }
+	for (i = 0; i < FLOW_MAX_DIST; i++) flow_bucket[i] = FLOW_NO_GRID;
 
-    // pull out the relevant monster info for the monster flows
-    if (which_flow < MAX_MONSTERS)
-    {
-        monster_flow = TRUE;
-        
-        m_ptr = &mon_list[which_flow];
-        r_ptr = &r_info[m_ptr->r_idx];
-    }
-    
-    // pull out the relevant monster info for the wandering monster flows
-    else if (which_flow <= FLOW_WANDERING_TAIL)
-    {
-        monster_flow = TRUE;
-        
-        // search the monsters to find one with that flow
-        for (i = 1; i < mon_max; i++)
-        {
-            m_ptr = &mon_list[i];
-            
-            // Skip dead monsters
-            if (!m_ptr->r_idx) continue;
+	flow_queue_min = FLOW_MAX_DIST;
+}
 
-            r_ptr = &r_info[m_ptr->r_idx];
+static void flow_queue_remove(int g)
+{
+	if (flow_prev[g] == FLOW_NO_GRID)  flow_bucket[flow_key[g]] = flow_next[g];
+	else                               flow_next[flow_prev[g]] = flow_next[g];
 
-            // find the first monster with this flow
-            if (m_ptr->wandering_idx == which_flow) found = TRUE;
-            
-            if (found) break;
-        }
-        
-        // stop if this is just a vestigial flow left after the monsters died
-        // (these are attempted to be reprocessed on save game load)
-        if (!found) return;
-    }
+	if (flow_next[g] != FLOW_NO_GRID)  flow_prev[flow_next[g]] = flow_prev[g];
 
-	/* Save the new flow epicenter */
-	flow_center_y[which_flow] = cy;
-	flow_center_x[which_flow] = cx;
-	update_center_y[which_flow] = cy;
-	update_center_x[which_flow] = cx;
+	flow_queued[g] = FALSE;
+}
 
-	/* Erase all of the current flow (noise) information */
+/*
+ * Adds a grid to the queue, or moves it if it is already there.
+ */
+static void flow_queue_push(int g, int key)
+{
+	if (flow_queued[g]) flow_queue_remove(g);
+
+	flow_key[g] = key;
+	flow_prev[g] = FLOW_NO_GRID;
+	flow_next[g] = flow_bucket[key];
+	if (flow_bucket[key] != FLOW_NO_GRID) flow_prev[flow_bucket[key]] = g;
+	flow_bucket[key] = g;
+	flow_queued[g] = TRUE;
+
+	if (key < flow_queue_min) flow_queue_min = key;
+}
+
+/*
+ * Takes a grid with the smallest key off the queue.
+ *
+ * Returns FLOW_NO_GRID if the queue is empty.
+ */
+static int flow_queue_pop(void)
+{
+	int g;
+
+	while ((flow_queue_min < FLOW_MAX_DIST) && (flow_bucket[flow_queue_min] == FLOW_NO_GRID))
+	{
+		flow_queue_min++;
+	}
+
+	if (flow_queue_min == FLOW_MAX_DIST) return (FLOW_NO_GRID);
+
+	g = flow_bucket[flow_queue_min];
+	flow_queue_remove(g);
+
+	return (g);
+}
+
+
+/*
+ * Most of the flows are unused at any given time (there are rarely more than a
+ * handful of movement classes or wandering groups on a level), so the memory for
+ * each one is only found when it is first built, and is handed back when the
+ * flow's owner has finished with it (see release_flow() and wipe_flows()).
+ *
+ * Released layers are kept in a small pool so that they can be reused without
+ * going back to the allocator.
+ */
+#define FLOW_POOL_MAX 16
+
+static GAME_LOCAL byte_wid *flow_pool[FLOW_POOL_MAX];
+static GAME_LOCAL int flow_pool_num = 0;
+
+
+/*
+ * Returns the layer for a flow, finding one if it doesn't have one yet.
+ */
+static byte_wid *flow_layer(int which_flow)
+{
+	byte_wid *layer = cave_cost[which_flow];
+
+	/* Already there */
+	if (layer) return (layer);
+
+	/* Reuse a released layer if possible */
+	if (flow_pool_num > 0)
+	{
+		layer = flow_pool[--flow_pool_num];
+	}
+	else
+	{
+		C_MAKE(layer, MAX_DUNGEON_HGT, byte_wid);
+	}
+
+	/* Nothing has been reached yet */
+	C_BSET(layer, FLOW_MAX_DIST, MAX_DUNGEON_HGT, byte_wid);
+
+	cave_cost[which_flow] = layer;
+
+	return (layer);
+}
+
+
+/*
+ * Hands back the memory for a flow that is no longer needed.
+ */
+void release_flow(int which_flow)
+{
+	byte_wid *layer = cave_cost[which_flow];
+
+	/* Nothing to do */
+	if (!layer) return;
+
+	cave_cost[which_flow] = NULL;
+
+	/* Keep it for later, or free it if the pool is full */
+	if (flow_pool_num < FLOW_POOL_MAX) flow_pool[flow_pool_num++] = layer;
+	else                               FREE(layer);
+}
+
+
+/*
+ * Releases all the flows (and forgets the movement classes) when a level ends.
+ */
+void wipe_flows(void)
+{
+	int i;
+
+	for (i = 0; i < MAX_FLOWS; i++)
+	{
+		release_flow(i);
+	}
+
+	(void)C_WIPE(flow_class, MAX_FLOW_CLASSES, flow_class_type);
+}
+
+
+/*
+ * Releases all the flows and frees the pool when a game ends.
+ */
+void free_flows(void)
+{
+	wipe_flows();
+
+	while (flow_pool_num > 0)
+	{
+		FREE(flow_pool[--flow_pool_num]);
+	}
+}
+
+
+/*
+ * Builds a flow from scratch, spreading outwards from the centre (cy, cx).
+ *
+ * 'cost_hook' gives the cost of entering the grid (y, x) from a grid at distance
+ * 'dist' (0 if it can't be entered at all), and is passed 'data' as well.
+ * Costs must only depend on the grid being entered, except that steps out of
+ * the centre itself may be cheaper.  This means that the first distance found
+ * for a grid is always the shortest, so each cost only needs to be worked out once.
+ *
+ * Grids that are FLOW_MAX_DIST or further away are left at FLOW_MAX_DIST.
+ *
+ * Returns the greatest distance reached.
+ */
+int flow_fill(int which_flow, int cy, int cx, int (*cost_hook)(int y, int x, int dist, void *data), void *data)
+{
+	byte *flow = &flow_layer(which_flow)[0][0];
+
+	int y, x, y2, x2;
+	int d, g, g2;
+	int dist, cost;
+	int max_dist = 0;
+
+	/* Save the new flow epicenter */
+	flow_center_y[which_flow] = cy;
+	flow_center_x[which_flow] = cx;
+	update_center_y[which_flow] = cy;
+	update_center_x[which_flow] = cx;
+
+	/* The flow is now up to date with the terrain */
+	flow_epoch[which_flow] = terrain_epoch;
+
+	/* Erase all of the current flow (noise) information */
 	for (y = 0; y < p_ptr->cur_map_hgt; y++)
 	{
 		for (x = 0; x < p_ptr->cur_map_wid; x++)
 		{
-			cave_cost[which_flow][y][x] = FLOW_MAX_DIST;
+			flow[FLOW_GRID(y, x)] = FLOW_MAX_DIST;
 		}
 	}
 
-	/*** Update or rebuild the flow ***/
+	/* Store base cost at the centre */
+	flow[FLOW_GRID(cy, cx)] = 0;
 
-	/* Store base cost at the character location */
-	cave_cost[which_flow][cy][cx] = 0;
+	flow_queue_wipe();
+	flow_queue_push(FLOW_GRID(cy, cx), 0);
 
-	/* Store this grid in the flow table, note that we've done so */
-	flow_table[this_cycle][0][0] = cy;
-	flow_table[this_cycle][1][0] = cx;
-	grid_count = 1;
+	/* Extend the flow out to its limits, nearest grids first */
+	while ((g = flow_queue_pop()) != FLOW_NO_GRID)
+	{
+		y = FLOW_GRID_Y(g);
+		x = FLOW_GRID_X(g);
+		dist = flow[g];
 
-	/* Extend the noise burst out to its limits */
-	for (cost = 1; cost <= FLOW_MAX_DIST; cost++)
+		max_dist = dist;
+
+		/* Look at all adjacent grids */
+		for (d = 0; d < 8; d++)
+		{
+			/* Child location */
+			y2 = y + ddy_ddd[d];
+			x2 = x + ddx_ddd[d];
+			g2 = FLOW_GRID(y2, x2);
+
+			/* Check Bounds */
+			if (!in_bounds(y2, x2)) continue;
+
+			/* Ignore previously marked grids, as they already have their shortest distance */
+			if (flow[g2] < FLOW_MAX_DIST) continue;
+
+			/* Find the cost of entering the grid, skipping impassable ones */
+			cost = (*cost_hook)(y2, x2, dist, data);
+			if (cost == 0) continue;
+
+			/* Grids beyond the limit are left unmarked */
+			if (dist + cost >= FLOW_MAX_DIST) continue;
+
+			/* Store cost at this location */
+			flow[g2] = dist + cost;
+			flow_queue_push(g2, dist + cost);
+		}
+	}
+
+	return (max_dist);
+}
+
+
+/*
+ * Mark a grid as affected by the terrain changes being repaired
+ */
+static void flow_mark_grid(int g, int *n)
+{
+	flow_mark[g] = flow_stamp;
+	flow_list[(*n)++] = g;
+}
+
+
+/*
+ * Queues up the neighbours of an affected grid which might have got their
+ * distance through it, to be checked in order of distance.
+ */
+static void flow_push_dependents(byte *flow, int g)
+{
+	int y = FLOW_GRID_Y(g);
+	int x = FLOW_GRID_X(g);
+	int d, g2;
+
+	for (d = 0; d < 8; d++)
 	{
-		/* Get the number of grids we'll be looking at */
-		last_index = grid_count;
+		g2 = FLOW_GRID(y + ddy_ddd[d], x + ddx_ddd[d]);
+
+		if (!in_bounds(y + ddy_ddd[d], x + ddx_ddd[d])) continue;
+		if (flow_mark[g2] == flow_stamp) continue;
+		if ((flow[g2] >= FLOW_MAX_DIST) || (flow[g2] <= flow[g])) continue;
+
+		flow_queue_push(g2, flow[g2]);
+	}
+}
+
+
+/*
+ * Brings a flow up to date with the terrain, without rebuilding it.
+ *
+ * cave_set_feat() keeps a log of the grids that have changed, so only the
+ * parts of the flow that depend on those grids need to be worked out again.
+ * The cost hook is as for flow_fill().
+ *
+ * First we find the grids whose routes may have got longer: the changed grids
+ * themselves, and any grids that got their distance through them and have no
+ * other route of the same length.  These are checked in order of distance,
+ * so that each grid is only checked once the grids it could depend on are known.
+ *
+ * Those grids are then wiped and given new distances from their unaffected
+ * neighbours, and the new distances are spread outwards as in Dijkstra's
+ * algorithm, which also takes care of any routes that have got shorter.
+ *
+ * 'reset' is called for each grid that is given a new distance (if not NULL).
+ *
+ * Returns FALSE if too much has changed since the flow was last up to date,
+ * in which case it should be rebuilt instead.
+ */
+bool flow_repair(int which_flow, int (*cost_hook)(int y, int x, int dist, void *data), void *data,
+                 void (*reset)(int y, int x))
+{
+	byte *flow;
+
+	int cg = FLOW_GRID(flow_center_y[which_flow], flow_center_x[which_flow]);
+
+	u32b changes = terrain_epoch - flow_epoch[which_flow];
+	u32b e;
+
+	int i, d, g, g2, n = 0;
+	int y, x, y2, x2;
+	int cost, dist;
 
-		/* Stop if we've run out of work to do */
-		if (last_index == 0) break;
+	/* The flow has never been built (or has been released) */
+	if (!cave_cost[which_flow]) return (FALSE);
 
-		/* Clear the grid count */
-		grid_count = 0;
+	flow = &cave_cost[which_flow][0][0];
 
-		/* Get each valid entry in the flow table in turn. */
-		for (i = 0; i < last_index; i++)
+	/* Nothing to do */
+	if (changes == 0) return (TRUE);
+
+	/* The changes have been forgotten */
+	if (changes > FLOW_DIRTY_MAX) return (FALSE);
+
+	/* Start a new set of marks */
+	flow_stamp++;
+	if (flow_stamp == 0)
+	{
+		for (g = 0; g < FLOW_GRIDS; g++) flow_mark[g] = 0;
+		flow_stamp = 1;
+	}
+
+	flow_queue_wipe();
+
+	/*** Find the grids whose distances might have increased ***/
+
+	/* The changed grids themselves (the centre is always at distance zero) */
+	for (e = flow_epoch[which_flow]; e != terrain_epoch; e++)
+	{
+		g = FLOW_GRID(flow_dirty_y[e % FLOW_DIRTY_MAX], flow_dirty_x[e % FLOW_DIRTY_MAX]);
+
+		if ((g == cg) || (flow_mark[g] == flow_stamp)) continue;
+
+		flow_mark_grid(g, &n);
+	}
+
+	for (i = 0; i < n; i++) flow_push_dependents(flow, flow_list[i]);
+
+	/* Check the grids in order of distance, spreading outwards from those that lose their route */
+	while ((g = flow_queue_pop()) != FLOW_NO_GRID)
+	{
+		bool supported = FALSE;
+
+		y = FLOW_GRID_Y(g);
+		x = FLOW_GRID_X(g);
+
+		/* Look for an unaffected neighbour that still provides the same distance */
+		for (d = 0; d < 8; d++)
 		{
-			/* Get this grid */
-			y = flow_table[this_cycle][0][i];
-			x = flow_table[this_cycle][1][i];
-			
-			// Some grids are not ready to process immediately.
-			// For example doors, which add 5 cost to noise, 3 cost to movement.
-			// They keep getting put back on the queue until ready.
-			if (cave_cost[which_flow][y][x] >= cost)
+			y2 = y + ddy_ddd[d];
+			x2 = x + ddx_ddd[d];
+			g2 = FLOW_GRID(y2, x2);
+
+			if (!in_bounds(y2, x2)) continue;
+			if ((flow_mark[g2] == flow_stamp) || (flow[g2] >= flow[g])) continue;
+
+			/* The terrain here is unchanged, so it still costs the same to enter */
+			if (flow[g2] + (*cost_hook)(y, x, flow[g2], data) == flow[g])
 			{
-				/* Store this grid in the flow table */
-				flow_table[next_cycle][0][grid_count] = y;
-				flow_table[next_cycle][1][grid_count] = x;
-				
-				/* Increment number of grids stored */
-				grid_count++;
+				supported = TRUE;
+				break;
 			}
-			
-			// if the grid is ready to process...
-			else
+		}
+
+		if (supported) continue;
+
+		/* This grid has lost its route, so its own dependents need checking */
+		flow_mark_grid(g, &n);
+		flow_push_dependents(flow, g);
+	}
+
+	/*** Work out new distances for the affected grids ***/
+
+	/* Wipe them */
+	for (i = 0; i < n; i++) flow[flow_list[i]] = FLOW_MAX_DIST;
+
+	/* Give them the best distance from their neighbours */
+	for (i = 0; i < n; i++)
+	{
+		g = flow_list[i];
+		y = FLOW_GRID_Y(g);
+		x = FLOW_GRID_X(g);
+
+		for (d = 0; d < 8; d++)
+		{
+			y2 = y + ddy_ddd[d];
+			x2 = x + ddx_ddd[d];
+			g2 = FLOW_GRID(y2, x2);
+
+			if (!in_bounds(y2, x2)) continue;
+			if (flow[g2] >= FLOW_MAX_DIST) continue;
+
+			cost = (*cost_hook)(y, x, flow[g2], data);
+			if (cost == 0) continue;
+
+			dist = flow[g2] + cost;
+			if ((dist < FLOW_MAX_DIST) && (dist < flow[g])) flow[g] = dist;
+		}
+
+		if (flow[g] < FLOW_MAX_DIST)
+		{
+			if (reset) (*reset)(y, x);
+			flow_queue_push(g, flow[g]);
+		}
+	}
+
+	/* The changed grids may also offer shorter routes to the rest of the flow */
+	for (e = flow_epoch[which_flow]; e != terrain_epoch; e++)
+	{
+		g = FLOW_GRID(flow_dirty_y[e % FLOW_DIRTY_MAX], flow_dirty_x[e % FLOW_DIRTY_MAX]);
+
+		if (flow[g] < FLOW_MAX_DIST) flow_queue_push(g, flow[g]);
+	}
+
+	/* Spread the new distances outwards */
+	while ((g = flow_queue_pop()) != FLOW_NO_GRID)
+	{
+		y = FLOW_GRID_Y(g);
+		x = FLOW_GRID_X(g);
+
+		for (d = 0; d < 8; d++)
+		{
+			y2 = y + ddy_ddd[d];
+			x2 = x + ddx_ddd[d];
+			g2 = FLOW_GRID(y2, x2);
+
+			if (!in_bounds(y2, x2)) continue;
+			if (flow[g2] <= flow[g]) continue;
+
+			cost = (*cost_hook)(y2, x2, flow[g], data);
+			if (cost == 0) continue;
+
+			dist = flow[g] + cost;
+			if ((dist >= FLOW_MAX_DIST) || (dist >= flow[g2])) continue;
+
+			if (reset) (*reset)(y2, x2);
+
+			flow[g2] = dist;
+			flow_queue_push(g2, dist);
+		}
+	}
+
+	/* The flow is now up to date with the terrain */
+	flow_epoch[which_flow] = terrain_epoch;
+
+	return (TRUE);
+}
+
+
+/*
+ * Finds the monster whose movement a flow is built for.
+ *
+ * The shared flows of alert monsters use the monster they were last built for,
+ * and the flows of wandering groups use the first monster in the group.
+ * The noise flows don't depend on any monster, so get NULL.
+ *
+ * Returns FALSE if it is a wandering flow whose monsters have all died, or a
+ * shared flow whose monster has died since (it is brought up to date for
+ * another monster of the class when next used).
+ */
+static bool flow_monster(int which_flow, monster_type **m_ptr_ptr)
+{
+	int i;
+
+	*m_ptr_ptr = NULL;
+
+	// shared flows of alert monsters
+	if (which_flow < MAX_FLOW_CLASSES)
+	{
+		int m_idx = mon_handle_idx(flow_class[which_flow].m_handle);
+
+		// the monster has died since (another of its class will take over)
+		if (!m_idx) return (FALSE);
+
+		*m_ptr_ptr = &mon_list[m_idx];
+	}
+
+	// wandering monster flows
+	else if (which_flow <= FLOW_WANDERING_TAIL)
+	{
+		// search the monsters to find the first one with that flow
+		for (i = 1; i < mon_max; i++)
+		{
+			monster_type *m_ptr = &mon_list[i];
+
+			// Skip dead monsters
+			if (!m_ptr->r_idx) continue;
+
+			if (m_ptr->wandering_idx == which_flow)
 			{
-				/* Look at all adjacent grids */
-				for (d = 0; d < 8; d++)
-				{
-                    int extra_cost = 0;
-                    
-					/* Child location */
-					y2 = y + ddy_ddd[d];
-					x2 = x + ddx_ddd[d];
-					
-					/* Check Bounds */
-					if (!in_bounds(y2, x2)) continue;
-					
-					/* Ignore previously marked grids, unless this is a shorter distance */
-					if (cave_cost[which_flow][y2][x2] < FLOW_MAX_DIST) continue;
-					               
-                    // Deal with monster pathfinding
-                    if (monster_flow)
-                    {
-                        // get the percentage chance of the monster being able to move onto that square
-                        int chance = cave_passable_mon(m_ptr, y2, x2, &bash);
-                        
-                        // if there is any chance, then convert it to a number of turns
-                        if (chance > 0)
-                        {
-                            extra_cost += (100 / chance) - 1;
-                            
-                            // add an extra turn for unlocking/opening doors as this action doesn't move the monster
-                            if (cave_any_closed_door_bold(y2, x2) && !bash)
-                            {
-                                if (!((r_ptr->flags2 & (RF2_PASS_DOOR)) || (r_ptr->flags2 & (RF2_PASS_WALL))))
-                                {
-                                    extra_cost += 1;
-                                }
-                            }
-                            
-                            // add extra turn(s) for tunneling through rubble/walls as this action doesn't move the monster
-                            else if (cave_wall_bold(y2, x2) && (r_ptr->flags2 & (RF2_TUNNEL_WALL)))
-                            {
-                                if (cave_feat[y2][x2] == FEAT_RUBBLE)   extra_cost += 1; // an extra turn to dig through
-                                else                                    extra_cost += 2; // two extra turns to dig through granite/quartz
-                            }
-                            
-                            else if (cave_wall_bold(y2, x2) && (r_ptr->flags2 & (RF2_KILL_WALL)))
-                            {
-                                extra_cost += 1; // pretend it would take an extra turn (to prefer routes with less wall destruction
-                            }
-                        }
-                        
-                        // if there is no chance, just skip this square
-                        else
-                        {
-                            continue;
-                        }
-                    }
-                    
-                    // Deal with noise flows
-                    else
-                    {
-                        // ignore walls
-                        if (cave_wall_bold(y2,x2) && (cave_feat[y2][x2] != FEAT_SECRET)) continue;
- 
-                        // penalize doors by 5 when calculating the real noise
-                        if (cave_any_closed_door_bold(y2,x2))
-                        {                                    
-                            extra_cost += 5;
-                        }
-                    }
-										
-					/* Monsters at this site need to re-consider their targets */
-                    
-					if (cave_m_idx[y2][x2] > 0)
-					{
-						monster_type *n_ptr = &mon_list[cave_m_idx[y2][x2]];
-						
-                        n_ptr->target_x = 0;
-                        n_ptr->target_y = 0;
-					}
+				*m_ptr_ptr = m_ptr;
+				break;
+			}
+		}
 
-                    /* Store cost at this location */
-					cave_cost[which_flow][y2][x2] = cost + extra_cost;
+		// this is just a vestigial flow left after the monsters died
+		if (*m_ptr_ptr == NULL) return (FALSE);
+	}
 
-					/* Store this grid in the flow table */
-					flow_table[next_cycle][0][grid_count] = y2;
-					flow_table[next_cycle][1][grid_count] = x2;
-					
-					/* Increment number of grids stored */
-					grid_count++;
-				}
+	return (TRUE);
+}
+
+
+/*
+ * Cost hook for the noise and monster flows.
+ *
+ * This is one for the step itself, plus extra for anything that slows it down,
+ * such as doors (for noise) or tunnelling (for monsters).  It only depends on the
+ * terrain, which is what allows these flows to be repaired rather than rebuilt.
+ *
+ * 'data' is the monster the flow is built for, or NULL for noise flows.
+ */
+static int flow_cost(int y, int x, int dist, void *data)
+{
+	monster_type *m_ptr = (monster_type *) data;
+
+	int cost = 1;
+
+	bool bash = FALSE;
+
+	/* Unused parameter */
+	(void)dist;
+
+	// Deal with monster pathfinding
+	if (m_ptr)
+	{
+		monster_race *r_ptr = &r_info[m_ptr->r_idx];
+
+		// get the percentage chance of the monster being able to move onto that square
+		// (flows ignore other monsters, as these are dealt with when moving)
+		int chance = cave_passable_terrain(m_ptr, y, x, 100, &bash);
+
+		// if there is no chance, the square is impassable
+		if (chance == 0) return (0);
+
+		// convert the chance to a number of turns
+		cost += (100 / chance) - 1;
+
+		// add an extra turn for unlocking/opening doors as this action doesn't move the monster
+		if (cave_any_closed_door_bold(y, x) && !bash)
+		{
+			if (!((r_ptr->flags2 & (RF2_PASS_DOOR)) || (r_ptr->flags2 & (RF2_PASS_WALL))))
+			{
+				cost += 1;
 			}
 		}
 
-		/* Swap write and read portions of the table */
-		if (this_cycle == 0)
+		// add extra turn(s) for tunneling through rubble/walls as this action doesn't move the monster
+		else if (cave_wall_bold(y, x) && (r_ptr->flags2 & (RF2_TUNNEL_WALL)))
 		{
-			this_cycle = 1;
-			next_cycle = 0;
+			if (cave_feat[y][x] == FEAT_RUBBLE)   cost += 1; // an extra turn to dig through
+			else                                  cost += 2; // two extra turns to dig through granite/quartz
 		}
-		else
+
+		else if (cave_wall_bold(y, x) && (r_ptr->flags2 & (RF2_KILL_WALL)))
+		{
+			cost += 1; // pretend it would take an extra turn (to prefer routes with less wall destruction
+		}
+	}
+
+	// Deal with noise flows
+	else
+	{
+		// ignore walls
+		if (cave_wall_bold(y, x) && (cave_feat[y][x] != FEAT_SECRET)) return (0);
+
+		// penalize doors by 5 when calculating the real noise
+		if (cave_any_closed_door_bold(y, x)) cost += 5;
+	}
+
+	return (cost);
+}
+
+
+/*
+ * Monsters standing where a flow has changed need to re-consider their targets
+ */
+static void flow_reset_target(int y, int x)
+{
+	if (cave_m_idx[y][x] > 0)
+	{
+		monster_type *n_ptr = &mon_list[cave_m_idx[y][x]];
+
+		n_ptr->target_x = 0;
+		n_ptr->target_y = 0;
+	}
+}
+
+
+/*
+ * Builds one of the noise or monster flows.
+ *
+ * Note that the noise is generated around the centre cy, cx
+ * This is often the player, but can be a monster (for FLOW_MONSTER_NOISE)
+ */
+void update_flow(int cy, int cx, int which_flow)
+{
+	int i;
+
+    monster_type *m_ptr;
+
+    // paranoia
+    if ((which_flow >= FLOW_AUTOMATON) && (which_flow <= FLOW_AUTOMATON_SECURE))
+    {
+        msg_debug("Tried to use update_flow() with FLOW_AUTOMATON_XXX.");
+        return;
+    }
+
+    // pull out the monster the flow is for (if any)
+    // stopping if this is just a vestigial flow left after the monsters died
+    // (these are attempted to be reprocessed on save game load)
+    if (!flow_monster(which_flow, &m_ptr)) return;
+
+	PROFILE_START(PROF_UPDATE_FLOW);
+
+	/* Build the flow */
+	(void)flow_fill(which_flow, cy, cx, flow_cost, m_ptr);
+
+	/* Monsters within the flow need to re-consider their targets */
+	for (i = 1; i < mon_max; i++)
+	{
+		monster_type *n_ptr = &mon_list[i];
+
+		/* Skip dead monsters */
+		if (!n_ptr->r_idx) continue;
+
+		/* Skip the centre and grids out of reach */
+		if ((n_ptr->fy == cy) && (n_ptr->fx == cx)) continue;
+		if (cave_cost[which_flow][n_ptr->fy][n_ptr->fx] >= FLOW_MAX_DIST) continue;
+
+		n_ptr->target_y = 0;
+		n_ptr->target_x = 0;
+	}
+
+	PROFILE_STOP(PROF_UPDATE_FLOW);
+}
+
+
+/*
+ * Brings one of the noise or monster flows up to date with any changes to the
+ * terrain since it was last built or repaired (see flow_repair()).
+ *
+ * If too much has changed, it is rebuilt instead.
+ */
+void repair_flow(int which_flow)
+{
+	monster_type *m_ptr;
+
+	/* Nothing to do */
+	if (cave_cost[which_flow] && (flow_epoch[which_flow] == terrain_epoch)) return;
+
+	/* Pull out the monster the flow is for (if any) */
+	if (!flow_monster(which_flow, &m_ptr)) return;
+
+	/* Repair the flow, or rebuild it if the changes have been forgotten */
+	if (!flow_repair(which_flow, flow_cost, m_ptr, flow_reset_target))
+	{
+		update_flow(flow_center_y[which_flow], flow_center_x[which_flow], which_flow);
+	}
+}
+
+
+/*
+ * Alert monsters find their way to the player using flows.
+ *
+ * Rather than each monster rebuilding its own flow every turn, monsters that
+ * would get identical flows (those with the same movement class) share one.
+ * A shared flow only needs to be rebuilt when the player has moved, and is
+ * repaired when the terrain has changed since it was last used, so a large
+ * group of alert monsters pays for a single flow per turn rather than one each.
+ *
+ * Returns the index of the flow that the monster should follow.
+ */
+int update_monster_flow(monster_type *m_ptr)
+{
+	monster_race *r_ptr = &r_info[m_ptr->r_idx];
+	flow_class_type *fc_ptr;
+
+	int py = p_ptr->py;
+	int px = p_ptr->px;
+
+	int i;
+	int which_flow = 0;
+
+	bool found = FALSE;
+
+	/* Work out the monster's movement class */
+	u32b flags = r_ptr->flags2 & (RF2_MOVE_MASK);
+	int per = monster_skill(m_ptr, S_PER);
+	int wil = monster_skill(m_ptr, S_WIL);
+	int str = monster_stat(m_ptr, A_STR);
+
+	/* Look for the class, remembering the least recently used one in case it is new */
+	for (i = 0; i < MAX_FLOW_CLASSES; i++)
+	{
+		fc_ptr = &flow_class[i];
+
+		if ((fc_ptr->turn > 0) && (fc_ptr->flags == flags) &&
+		    (fc_ptr->per == per) && (fc_ptr->wil == wil) && (fc_ptr->str == str))
 		{
-			this_cycle = 0;
-			next_cycle = 1;
+			which_flow = i;
+			found = TRUE;
+			break;
 		}
+
+		if (fc_ptr->turn < flow_class[which_flow].turn) which_flow = i;
 	}
+
+	fc_ptr = &flow_class[which_flow];
+
+	/* Take over the least recently used flow for a new class */
+	if (!found)
+	{
+		fc_ptr->flags = flags;
+		fc_ptr->per = per;
+		fc_ptr->wil = wil;
+		fc_ptr->str = str;
+	}
+
+	/* Note that the class is in use */
+	fc_ptr->turn = turn;
+
+	/* This monster stands in for the class when working out costs */
+	fc_ptr->m_handle = mon_handle(cave_m_idx[m_ptr->fy][m_ptr->fx]);
+
+	/* Rebuild the flow if it is new or the player has moved */
+	if (!found || !cave_cost[which_flow] || (flow_center_y[which_flow] != py) || (flow_center_x[which_flow] != px))
+	{
+		update_flow(py, px, which_flow);
+	}
+
+	/* Otherwise just catch up with any changes to the terrain */
+	else
+	{
+		repair_flow(which_flow);
+	}
+
+	/* Remember which flow the monster is using */
+	m_ptr->flow = which_flow;
+
+	return (which_flow);
 }
 
 
@@ -3917,7 +4708,7 @@ void update_smell(void)
 			}
 
 			/* Grid must not be blocked by walls from the character */
-			if (!los(p_ptr->py, p_ptr->px, y, x)) continue;
+			if (!los_from_player(y, x)) continue;
 
 			/* Note grids that are too far away */
 			if (scent_adjust[i][j] == 250) continue;
@@ -4182,6 +4973,14 @@ void gates_illuminate(bool daytime)
 void cave_set_feat(int y, int x, int feat)
 {
 
+	/* Log the change so that flows can be repaired (see repair_flow()) */
+	if (cave_feat[y][x] != feat)
+	{
+		flow_dirty_y[terrain_epoch % FLOW_DIRTY_MAX] = y;
+		flow_dirty_x[terrain_epoch % FLOW_DIRTY_MAX] = x;
+		terrain_epoch++;
+	}
+
 	/* Change the feature */
 	cave_feat[y][x] = feat;
 
@@ -483,6 +483,7 @@ int hit_roll(int att, int evn, const monster_type *m_ptr1, const monster_type *m
 	int attack_score, attack_score_alt;
 	int evasion_score, evasion_score_alt;
 	bool non_player_visible;
+	u16b old_stream = Rand_stream;
 	
 	// determine the visibility for  the combat roll window
 	if (m_ptr1 == PLAYER)
@@ -496,11 +497,13 @@ int hit_roll(int att, int evn, const monster_type *m_ptr1, const monster_type *m
 		else				non_player_visible = m_ptr1->ml;
 	}
 
-	// roll the dice...
+	// roll the dice (with the combat random numbers)...
+	Rand_stream = RAND_STREAM_COMBAT;
 	attack_score = dieroll(20) + att;
 	attack_score_alt = dieroll(20) + att;
 	evasion_score = dieroll(20) + evn;
 	evasion_score_alt = dieroll(20) + evn;
+	Rand_stream = old_stream;
 
 	// take the worst of two rolls for cursed players
 	if (p_ptr->cursed)
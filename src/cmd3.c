@@ -887,7 +887,7 @@ void shatter_weapon(int silnum)
 		/* If Morgoth, then anger him */
 		if (m_ptr->r_idx == R_IDX_MORGOTH)
 		{
-			if ((m_ptr->cdis <= 5) && los(p_ptr->py, p_ptr->px, m_ptr->fy, m_ptr->fx))
+			if ((m_ptr->cdis <= 5) && los_from_player(m_ptr->fy, m_ptr->fx))
 			{
 				msg_print("A shard strikes Morgoth upon his cheek.");
 				set_alertness(m_ptr, ALERTNESS_VERY_ALERT);
@@ -802,6 +802,14 @@ int bane_bonus_aux(void)
 	return (bonus);
 }
 
+/*
+ * The race flag of the monsters the player's bane ability applies to
+ */
+u32b bane_race_flag(void)
+{
+	return (bane_flag[p_ptr->bane_type]);
+}
+
 int bane_bonus(monster_type *m_ptr)
 {
 	int bonus = 0;
@@ -1475,7 +1483,7 @@ void do_cmd_ability_screen(void)
 }
 
 
-bool enchant_then_numbers;
+GAME_LOCAL bool enchant_then_numbers;
 
 /*
  * A structure to hold a tval and its description
@@ -1488,16 +1496,15 @@ typedef struct smithing_tval_desc
 } smithing_tval_desc;
 
 // object being created
-object_type smith_o_body;
-object_type *smith_o_ptr = &smith_o_body;
+GAME_LOCAL object_type smith_o_body;
 
 // backup object
-object_type smith2_o_body;
-object_type *smith2_o_ptr = &smith2_o_body;
+GAME_LOCAL object_type smith2_o_body;
+#define smith2_o_ptr	(&smith2_o_body)
 
 // super backup object
-object_type smith3_o_body;
-object_type *smith3_o_ptr = &smith3_o_body;
+GAME_LOCAL object_type smith3_o_body;
+#define smith3_o_ptr	(&smith3_o_body)
 
 // artefact being created
 #define smith_a_name	(z_info->art_self_made_max - 1)
@@ -1529,7 +1536,7 @@ typedef struct smithing_cost_type
     int artifice;
 } smithing_cost_type;
 
-smithing_cost_type smithing_cost;
+GAME_LOCAL smithing_cost_type smithing_cost;
 
 #define CAT_WEAPON  0
 #define CAT_ARMOUR  1
@@ -188,6 +188,13 @@
 #define ALLOW_REPEAT
 
 
+/*
+ * OPTION: Time the main parts of the game loop, with a report in the debug
+ * commands and on the standard error when the game exits (see util.c)
+ */
+/* #define ALLOW_PROFILE */
+
+
 /*
  * OPTION: Handle signals
  */
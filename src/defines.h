@@ -76,6 +76,75 @@
 #define RANDART_VERSION	62
 
 
+/*
+ * Default turn limit for batch games (see main.c)
+ * Games that reach it are stopped even if the character is still alive.
+ */
+#define BATCH_TURN_LIMIT	1000000L
+
+/*
+ * The start of the first line of a keypress log (see util.c)
+ */
+#define KEYLOG_HEADER	"Sil keylog 1"
+
+/*
+ * The byte that starts anything in a keypress log which isn't a plain key
+ */
+#define KEYLOG_ESCAPE	0xFF
+
+
+/*
+ * Parts of the game timed by the profiler (see "profile_start()")
+ */
+#define PROF_PROCESS_PLAYER		0
+#define PROF_PROCESS_MONSTERS	1
+#define PROF_PROCESS_MONSTER	2
+#define PROF_UPDATE_FLOW		3
+#define PROF_UPDATE_VIEW		4
+#define PROF_UPDATE_MONSTERS	5
+#define PROF_PROCESS_WORLD		6
+#define PROF_REDRAW_STUFF		7
+#define PROF_WINDOW_STUFF		8
+#define PROF_GENERATE_CAVE		9
+#define PROF_MAX				10
+
+/*
+ * Events counted by the profiler (see "profile_count()")
+ */
+#define PROF_LOS_QUERIES		0
+#define PROF_LOS_HITS			1
+#define PROF_FIELD_QUERIES		2
+#define PROF_FIELD_HITS			3
+#define PROF_LEVELS				4
+#define PROF_LEVEL_ATTEMPTS		5
+#define PROF_GAME_TURNS			6
+#define PROF_IDLE_TURNS			7
+#define PROF_COUNT_MAX			8
+
+/*
+ * Start and stop the profiler's timer for one of the parts above, or count
+ * one (or several) of the events.
+ * These vanish entirely unless ALLOW_PROFILE is defined (see config.h).
+ */
+#ifdef ALLOW_PROFILE
+# define PROFILE_START(N)	profile_start(N)
+# define PROFILE_STOP(N)	profile_stop(N)
+# define PROFILE_COUNT(N)	profile_count(N)
+# define PROFILE_ADD(N,X)	profile_add(N, X)
+#else
+# define PROFILE_START(N)	((void)0)
+# define PROFILE_STOP(N)	((void)0)
+# define PROFILE_COUNT(N)	((void)0)
+# define PROFILE_ADD(N,X)	((void)0)
+#endif
+
+
+/*
+ * Number of results held by the "los()" cache (must be a power of two)
+ */
+#define LOS_CACHE_SIZE		4096
+
+
 /*
  * Number of grids in each block (vertically)
  * Probably hard-coded to 11, see "generate.c"
@@ -137,6 +206,13 @@
  */
 #define MAX_DUNGEON_WID		(5 * 33)
 
+/*
+ * Number of bits in each word of a packed row of the map (see "bits_wid"),
+ * and number of words in each row
+ */
+#define MAP_WORD_BITS		((int)(8 * sizeof(u32b)))
+#define MAP_WORDS			((MAX_DUNGEON_WID + MAP_WORD_BITS - 1) / MAP_WORD_BITS)
+
 /*
  * Max number of rooms in dungeon.
  */
@@ -269,7 +345,9 @@
  * These are part of the structure of the arrays representing the 'monster flows'
  * (cave_cost, flow_center, update_center, wandering_pause)
  *
- *   0 - 299: flows for each of the monsters on the level
+ * Only the flows that are in use have memory for their cave_cost layer.
+ *
+ *   0 - 299: flows shared by alert monsters of the same movement class
  * 300 - 399: flows for each of the wandering monster groups on the level
  *       400: flow for the noise generated by the player
  *       401: flow for the noise generated by a monster
@@ -283,6 +361,18 @@
 #define FLOW_AUTOMATON_SECURE   FLOW_WANDERING_TAIL + 5
 #define MAX_FLOWS               FLOW_WANDERING_TAIL + 6
 
+/*
+ * The number of movement classes that can have a flow at once
+ * (one for each of the first MAX_MONSTERS flows)
+ */
+#define MAX_FLOW_CLASSES        MAX_MONSTERS
+
+/*
+ * The number of terrain changes remembered for repairing flows
+ * (flows that fall further behind than this are rebuilt)
+ */
+#define FLOW_DIRTY_MAX          1024
+
 /*
  * Maximum distance from the character to store flow (noise) information
  */
@@ -1571,9 +1661,9 @@
 #define CAVE_FIRE       0x0100  /* is in line of fire */
 #define CAVE_SEEN     	0x0200  /* seen flag */
 #define CAVE_VIEW       0x0400  /* view flag */
-#define CAVE_OLD_VIEW   0x0800  /* was square in view last update? */
-#define CAVE_OLD_LIT    0x1000  /* was square lit last update? */
-#define CAVE_OLD_TORCH  0x2000  /* was square in torch radius last update? */
+#define CAVE_ATT0       0x0800  /* unused */
+#define CAVE_ATT1       0x1000  /* unused */
+#define CAVE_ATT2       0x2000  /* unused */
 #define CAVE_KNOWN      0x4000  /* seen by the player previously */
 #define CAVE_ATT3       0x8000  /* unused */
 
@@ -2296,6 +2386,12 @@
 						 RF2_OPPORTUNIST | RF2_ZONE_OF_CONTROL | RF2_CRUEL_BLOW | \
                          RF2_EXCHANGE_PLACES | RF2_RIPOSTE | RF2_FLANKING)
 
+/*
+ * The flags that affect which grids a monster can move through (its movement class)
+ */
+#define RF2_MOVE_MASK	(RF2_FLYING | RF2_PASS_DOOR | RF2_UNLOCK_DOOR | RF2_OPEN_DOOR | \
+						 RF2_BASH_DOOR | RF2_PASS_WALL | RF2_KILL_WALL | RF2_TUNNEL_WALL)
+
 /*
  * New monster race bit flags
  */
@@ -2839,6 +2935,18 @@
  */
 #define term_screen	(angband_term[0])
 
+/*
+ * Hack -- The player records (these are not pointer variables, so that each
+ * thread's game can find its own player, see "GAME_LOCAL")
+ */
+#define op_ptr	(&player_other_body)
+#define p_ptr	(&player_type_body)
+
+/*
+ * Hack -- The object being smithed (see "p_ptr")
+ */
+#define smith_o_ptr	(&smith_o_body)
+
 /*
  * Monster macros
  */
@@ -3067,6 +3175,19 @@
 	((int)((G) % 256U))
 
 
+/*
+ * Convert a location (Y,X) into an index into a flow (and back again)
+ */
+#define FLOW_GRID(Y,X) \
+	((Y) * MAX_DUNGEON_WID + (X))
+
+#define FLOW_GRID_Y(G) \
+	((G) / MAX_DUNGEON_WID)
+
+#define FLOW_GRID_X(G) \
+	((G) % MAX_DUNGEON_WID)
+
+
 /*
  * Determines if a map location is "meaningful"
  */
@@ -329,6 +329,68 @@ int regen_amount(int turn_number, int max, int regen_period)
 }
 
 
+/*
+ *  Determines how many more turns it takes to regenerate 'amount' points
+ *  at the rate of regen_amount() above, starting after 'turn_number'.
+ *
+ *  The amounts regen_amount() hands out add up to (max * t) / regen_period
+ *  over the first 't' turns, so this is worked out directly rather than by
+ *  stepping through the turns one by one.
+ */
+int regen_turns(int turn_number, int max, int regen_period, int amount)
+{
+	int so_far;
+
+	if ((amount <= 0) || (max <= 0)) return (0);
+
+	/* Whole periods give exactly 'max' points, so only the remainder matters */
+	turn_number %= regen_period;
+	so_far = (max * turn_number) / regen_period;
+
+	/* The first turn at which (max * t) / regen_period reaches so_far + amount */
+	return (((so_far + amount) * regen_period + max - 1) / max - turn_number);
+}
+
+
+/*
+ * The rate at which the player regains health, as a multiple of the normal
+ * rate (0 if something is stopping it).
+ */
+int player_regen_multiplier(void)
+{
+	/* Regeneration ability */
+	int regen_multiplier = p_ptr->regenerate + 1;
+
+	/* Various things interfere with healing */
+	if (p_ptr->food < PY_FOOD_STARVE) regen_multiplier = 0;
+	if (p_ptr->poisoned) regen_multiplier = 0;
+	if (p_ptr->cut) regen_multiplier = 0;
+
+	if (singing(SNG_ESTE))
+	{
+		regen_multiplier *= ability_bonus(S_SNG, SNG_ESTE);
+	}
+
+	return (regen_multiplier);
+}
+
+
+/*
+ *  The total that regen_amount() hands out over the 'n' turns starting
+ *  with 'turn_number'.
+ */
+static int regen_amount_total(int turn_number, int n, int max, int regen_period)
+{
+	int first = MAX(turn_number - 1, 0);
+	int last = turn_number + n - 1;
+
+	/* The first 't' turns give (max * t) / regen_period in total */
+	return ((last / regen_period - first / regen_period) * max +
+	        (max * (last % regen_period)) / regen_period -
+	        (max * (first % regen_period)) / regen_period);
+}
+
+
 /*
  * Regenerate hit points
  */
@@ -414,15 +476,12 @@ static void regen_monsters(void)
 	int regen_period;
 
 	/* Regenerate everyone */
-	for (i = 1; i < mon_max; i++)
+	for (i = 0; i < mon_live_num; i++)
 	{
-		/* Check the i'th monster */
-		monster_type *m_ptr = &mon_list[i];
+		/* Check the i'th live monster */
+		monster_type *m_ptr = &mon_list[mon_live[i]];
 		monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-		/* Skip dead monsters */
-		if (!m_ptr->r_idx) continue;
-
 		/* Allow hp regeneration, if needed. */
 		if (m_ptr->hp != m_ptr->maxhp)
 		{
@@ -531,6 +590,8 @@ static void process_world(void)
 	/* Stop now unless the turn count is divisible by 10 */
 	if (turn % 10) return;
 
+	PROFILE_START(PROF_PROCESS_WORLD);
+
 	/*** Check the Time and Load ***/
 	if (!(turn % 1000))
 	{
@@ -725,6 +786,7 @@ static void process_world(void)
 		if (!o_ptr->k_idx) continue;
 	}
 
+	PROFILE_STOP(PROF_PROCESS_WORLD);
 }
 
 /*
@@ -1506,16 +1568,16 @@ static void process_player_aux(void)
 	int i;
 	bool changed = FALSE;
 
-	static int old_monster_race_idx = 0;
+	static GAME_LOCAL int old_monster_race_idx = 0;
 
-	static u32b	old_flags1 = 0L;
-	static u32b	old_flags2 = 0L;
-	static u32b	old_flags3 = 0L;
-	static u32b	old_flags4 = 0L;
+	static GAME_LOCAL u32b	old_flags1 = 0L;
+	static GAME_LOCAL u32b	old_flags2 = 0L;
+	static GAME_LOCAL u32b	old_flags3 = 0L;
+	static GAME_LOCAL u32b	old_flags4 = 0L;
 
-	static byte old_blows[MONSTER_BLOW_MAX];
+	static GAME_LOCAL byte old_blows[MONSTER_BLOW_MAX];
 
-	static byte	old_ranged = 0;
+	static GAME_LOCAL byte	old_ranged = 0;
 
 
 	/* Tracking a monster */
@@ -1569,6 +1631,372 @@ static void process_player_aux(void)
 }
 
 
+/*
+ * Is there anything within reach of "search()" that could still be found?
+ */
+static bool hidden_things_nearby(void)
+{
+	int y, x;
+	object_type *o_ptr;
+
+	for (y = p_ptr->py - 4; y <= p_ptr->py + 4; y++)
+	{
+		for (x = p_ptr->px - 4; x <= p_ptr->px + 4; x++)
+		{
+			if (!in_bounds(y, x)) continue;
+
+			/* Hidden traps and secret doors */
+			if (cave_trap_bold(y, x) && (cave_info[y][x] & (CAVE_HIDDEN))) return (TRUE);
+			if (cave_feat[y][x] == FEAT_SECRET) return (TRUE);
+
+			/* Unknown chest traps */
+			for (o_ptr = get_first_object(y, x); o_ptr; o_ptr = get_next_object(o_ptr))
+			{
+				if ((o_ptr->tval == TV_CHEST) && chest_traps[o_ptr->pval] && !object_known_p(o_ptr))
+				{
+					return (TRUE);
+				}
+			}
+		}
+	}
+
+	return (FALSE);
+}
+
+
+/*
+ * How much the timeout of an equipped object goes down by in each call to
+ * "process_world()" (a light that isn't fuelled counts twice, as it is
+ * also recharging).
+ */
+static int timeout_steps(int slot)
+{
+	object_type *o_ptr = &inventory[slot];
+	int steps = 0;
+
+	if ((slot == INVEN_LITE) && (o_ptr->tval == TV_LIGHT)) steps++;
+	if (!fuelable_light_p(o_ptr)) steps++;
+
+	return (steps);
+}
+
+
+/*
+ * Can a monster be left alone for the turns of a bulk rest?
+ *
+ * It must be asleep and out of view, with nothing wearing off and nothing
+ * for "recover_monster()" to do, so that its turns would change nothing
+ * but its health and its chance of noticing the player.
+ */
+static bool monster_rests_quietly(const monster_type *m_ptr)
+{
+	monster_race *r_ptr = &r_info[m_ptr->r_idx];
+
+	if (m_ptr->alertness >= ALERTNESS_UNWARY) return (FALSE);
+	if (m_ptr->ml) return (FALSE);
+	if (m_ptr->mflag & (MFLAG_SUMMONED)) return (FALSE);
+	if ((r_ptr->flags2 & (RF2_CLOUD_SURROUND)) && (m_ptr->mflag & (MFLAG_ACTV))) return (FALSE);
+	if (m_ptr->stunned || m_ptr->confused || m_ptr->hasted || m_ptr->slowed) return (FALSE);
+	if (m_ptr->tmp_morale != 0) return (FALSE);
+	if (m_ptr->song != SNG_NOTHING) return (FALSE);
+
+	return (TRUE);
+}
+
+
+/*
+ * Take the rest of a long rest all at once, when nothing can happen.
+ *
+ * If every monster is asleep and out of view, and the player is doing
+ * nothing but getting better, a turn of rest changes very little: health,
+ * voice, food, light and the timed effects all move on at known rates.  So
+ * the turns up to the next point at which something changes (the rest
+ * ending, a new hunger level, the light growing faint, or a timed effect
+ * running out) are worked out, and their effects applied in one go.
+ *
+ * The things that can't be worked out in advance -- a monster noticing the
+ * player, a wandering monster turning up, and noticing a passive ability --
+ * are still drawn for turn by turn, and stop the rest at the turn in which
+ * they happen.
+ *
+ * This is called at the end of a turn of rest, and stands in for the turns
+ * of rest that follow it (and for the calls to "process_world()" in between).
+ */
+static void rest_in_bulk(void)
+{
+	int i, j, n;
+	int num;
+	int rate;
+	int level;
+	int regen_multiplier;
+	int first_tick;
+	int digested = 0;
+	bool noticed = FALSE;
+	bool wanderer = FALSE;
+	bool wraith = FALSE;
+	bool ident = FALSE;
+	bool was_ghost;
+	monster_type *m_ptr;
+	object_type *o_ptr;
+
+	s16b *timed[] =
+	{
+		&p_ptr->image, &p_ptr->blind, &p_ptr->tim_invis, &p_ptr->confused,
+		&p_ptr->afraid, &p_ptr->darkened, &p_ptr->fast, &p_ptr->slow,
+		&p_ptr->rage, &p_ptr->tmp_str, &p_ptr->tmp_dex, &p_ptr->tmp_con,
+		&p_ptr->tmp_gra, &p_ptr->oppose_fire, &p_ptr->oppose_cold,
+		&p_ptr->oppose_pois, &p_ptr->stun
+	};
+
+	/*** Check that nothing can happen ***/
+
+	if (p_ptr->leaving || p_ptr->is_dead || p_ptr->restoring) return;
+	if (cheat_timestop) return;
+
+	/* The player must be simply waiting */
+	if (!singing(SNG_NOTHING)) return;
+	if (p_ptr->poisoned || p_ptr->cut || p_ptr->entranced || (p_ptr->stun > 100)) return;
+	if (p_ptr->wrath) return;
+	if (p_ptr->food < PY_FOOD_STARVE) return;
+
+	/* One turn of the player's for every ten game turns */
+	if (extract_energy[p_ptr->pspeed] != 10) return;
+
+	/* Nothing to be found by searching */
+	if (hidden_things_nearby()) return;
+
+	/* Every monster asleep and out of view */
+	for (i = 0; i < mon_live_num; i++)
+	{
+		if (!monster_rests_quietly(&mon_list[mon_live[i]])) return;
+	}
+
+	/*** Work out how many turns can be taken at once ***/
+
+	/* The rest count */
+	n = (p_ptr->resting > 0) ? p_ptr->resting : 10000;
+
+	/* Resting until healed */
+	regen_multiplier = player_regen_multiplier();
+	if ((p_ptr->resting == -1) ||
+	    ((p_ptr->resting == -2) && !p_ptr->blind && !p_ptr->confused && !p_ptr->afraid &&
+	     !p_ptr->stun && !p_ptr->slow))
+	{
+		int hp_turns = 0;
+		int sp_turns = 0;
+
+		if ((p_ptr->chp < p_ptr->mhp) && (regen_multiplier > 0))
+		{
+			hp_turns = regen_turns(MAX(playerturn - 1, 0), p_ptr->mhp,
+			                       PY_REGEN_HP_PERIOD / regen_multiplier, p_ptr->mhp - p_ptr->chp);
+		}
+		if (p_ptr->csp < p_ptr->msp)
+		{
+			sp_turns = regen_turns(MAX(playerturn - 1, 0), p_ptr->msp,
+			                       PY_REGEN_SP_PERIOD / (p_ptr->regenerate + 1), p_ptr->msp - p_ptr->csp);
+		}
+		n = MIN(n, MAX(hp_turns, sp_turns));
+	}
+
+	/* Stop short of the next hunger level */
+	rate = (p_ptr->hunger > 0) ? int_exp(3, p_ptr->hunger) : 1;
+	if (p_ptr->food >= PY_FOOD_MAX) rate *= 9;
+
+	if (p_ptr->food >= PY_FOOD_MAX)			level = PY_FOOD_MAX;
+	else if (p_ptr->food >= PY_FOOD_FULL)	level = PY_FOOD_FULL;
+	else if (p_ptr->food >= PY_FOOD_ALERT)	level = PY_FOOD_ALERT;
+	else if (p_ptr->food >= PY_FOOD_WEAK)	level = PY_FOOD_WEAK;
+	else									level = PY_FOOD_STARVE;
+
+	n = MIN(n, (p_ptr->food - level) / rate);
+
+	/* Stop short of the timed effects running out (or a stun getting lighter) */
+	for (i = 0; i < (int)N_ELEMENTS(timed); i++)
+	{
+		if (*timed[i]) n = MIN(n, *timed[i] - 1);
+	}
+	if (p_ptr->stun > 50) n = MIN(n, p_ptr->stun - 51);
+
+	/* Stop short of the light growing faint, and of anything recharging */
+	for (i = INVEN_WIELD; i < INVEN_TOTAL; i++)
+	{
+		o_ptr = &inventory[i];
+
+		if (!o_ptr->k_idx || (o_ptr->timeout <= 0)) continue;
+
+		if ((i == INVEN_LITE) && (o_ptr->tval == TV_LIGHT)) n = MIN(n, (o_ptr->timeout - 101) / timeout_steps(i));
+		else if (!fuelable_light_p(o_ptr))					n = MIN(n, o_ptr->timeout - 1);
+	}
+
+	/* Not worth it for a turn or two */
+	if (n < 2) return;
+
+	/*** Draw for the things that can't be worked out ***/
+
+	num = quiet_perception_gather(stealth_score);
+
+	for (j = 1; j <= n; j++)
+	{
+		/* The monsters' chance to notice the player */
+		if (quiet_perception_roll(num, stealth_score)) noticed = TRUE;
+
+		/* Noticing passive abilities */
+		if (one_in_(500)) ident = TRUE;
+
+		/* Slow hunger rates are done statistically */
+		if ((p_ptr->hunger < 0) && one_in_(int_exp(3, -(p_ptr->hunger)))) digested += rate;
+
+		/* Wandering monsters (as in "process_world()") */
+		if (p_ptr->depth == 0)
+		{
+			if (percent_chance(10)) wanderer = TRUE;
+		}
+		if (silmarils_possessed() >= 2)
+		{
+			if (percent_chance((p_ptr->cur_map_hgt * p_ptr->cur_map_wid) / (PANEL_HGT * PANEL_WID_FIXED)))
+			{
+				wanderer = TRUE;
+			}
+		}
+		else if (one_in_(MAX_M_ALLOC_CHANCE))
+		{
+			wanderer = TRUE;
+		}
+		if (percent_chance(p_ptr->haunted)) wraith = TRUE;
+
+		/* The scent trail keeps ageing */
+		update_smell();
+
+		if (noticed || ident || wanderer || wraith) break;
+	}
+
+	/* The number of turns taken */
+	n = MIN(j, n);
+
+	/*** Apply the turns ***/
+
+	/* Voice and health */
+	if (p_ptr->csp < p_ptr->msp)
+	{
+		p_ptr->csp = MIN(p_ptr->csp + regen_amount_total(playerturn, n, p_ptr->msp,
+		                                                 PY_REGEN_SP_PERIOD / (p_ptr->regenerate + 1)),
+		                 p_ptr->msp);
+	}
+	if ((p_ptr->chp < p_ptr->mhp) && (regen_multiplier > 0))
+	{
+		p_ptr->chp = MIN(p_ptr->chp + regen_amount_total(playerturn, n, p_ptr->mhp,
+		                                                 PY_REGEN_HP_PERIOD / regen_multiplier),
+		                 p_ptr->mhp);
+	}
+
+	/* Food */
+	if (p_ptr->hunger >= 0) digested = n * rate;
+	(void)set_food(p_ptr->food - digested);
+
+	/* Timed effects */
+	if (p_ptr->image)		(void)set_image(p_ptr->image - n);
+	if (p_ptr->blind)		(void)set_blind(p_ptr->blind - n);
+	if (p_ptr->tim_invis)	(void)set_tim_invis(p_ptr->tim_invis - n);
+	if (p_ptr->confused)	(void)set_confused(p_ptr->confused - n);
+	if (p_ptr->afraid)		(void)set_afraid(p_ptr->afraid - n);
+	if (p_ptr->darkened)	(void)set_darkened(p_ptr->darkened - n);
+	if (p_ptr->fast)		(void)set_fast(p_ptr->fast - n);
+	if (p_ptr->slow)		(void)set_slow(p_ptr->slow - n);
+	if (p_ptr->rage)		(void)set_rage(p_ptr->rage - n);
+	if (p_ptr->tmp_str)		(void)set_tmp_str(p_ptr->tmp_str - n);
+	if (p_ptr->tmp_dex)		(void)set_tmp_dex(p_ptr->tmp_dex - n);
+	if (p_ptr->tmp_con)		(void)set_tmp_con(p_ptr->tmp_con - n);
+	if (p_ptr->tmp_gra)		(void)set_tmp_gra(p_ptr->tmp_gra - n);
+	if (p_ptr->oppose_fire)	(void)set_oppose_fire(p_ptr->oppose_fire - n);
+	if (p_ptr->oppose_cold)	(void)set_oppose_cold(p_ptr->oppose_cold - n);
+	if (p_ptr->oppose_pois)	(void)set_oppose_pois(p_ptr->oppose_pois - n);
+	if (p_ptr->stun)		(void)set_stun(p_ptr->stun - n);
+
+	/* The staircasiness decays a little each turn */
+	for (j = 0; (j < n) && (p_ptr->staircasiness > 0); j++)
+	{
+		if (p_ptr->on_the_run)	p_ptr->staircasiness -= (p_ptr->staircasiness + 99) / 100;
+		else					p_ptr->staircasiness -= (p_ptr->staircasiness + 999) / 1000;
+	}
+
+	p_ptr->forge_drought += n;
+
+	/* Light and recharging */
+	for (i = INVEN_WIELD; i < INVEN_TOTAL; i++)
+	{
+		o_ptr = &inventory[i];
+
+		if (!o_ptr->k_idx || (o_ptr->timeout <= 0)) continue;
+
+		o_ptr->timeout -= n * timeout_steps(i);
+	}
+
+	/* The monsters regenerate, and use up their energy as they would have */
+	first_tick = (turn + 9) / 10;
+	for (i = 0; i < mon_live_num; i++)
+	{
+		monster_race *r_ptr;
+		int energy;
+
+		m_ptr = &mon_list[mon_live[i]];
+		r_ptr = &r_info[m_ptr->r_idx];
+
+		/* Each game turn takes 100 energy if it has that much, then gives it more */
+		energy = m_ptr->energy + 10 * n * extract_energy[m_ptr->mspeed];
+		m_ptr->energy = energy - 100 * ((energy - extract_energy[m_ptr->mspeed]) / 100);
+
+		/* (one with more energy than the player had takes its turn before the player's) */
+		if ((m_ptr->energy >= 100) && (m_ptr->energy > p_ptr->energy + p_ptr->energy_use)) m_ptr->energy -= 100;
+
+		if (m_ptr->hp != m_ptr->maxhp)
+		{
+			int regen_period = (r_ptr->flags2 & (RF2_REGENERATE)) ? MON_REGEN_HP_PERIOD / 5 : MON_REGEN_HP_PERIOD;
+
+			m_ptr->hp = MIN(m_ptr->hp + regen_amount_total(first_tick, n, m_ptr->maxhp, regen_period),
+			                m_ptr->maxhp);
+			if (m_ptr->hp == m_ptr->maxhp) m_ptr->min_range = 0;
+		}
+		if (m_ptr->mana != MON_MANA_MAX)
+		{
+			m_ptr->mana = MIN(m_ptr->mana + regen_amount_total(first_tick, n, MON_MANA_MAX, MON_REGEN_SP_PERIOD),
+			                  MON_MANA_MAX);
+			if (m_ptr->mana == MON_MANA_MAX) m_ptr->min_range = 0;
+		}
+	}
+
+	/* The record of the player's actions */
+	for (j = 0; (j < n) && (j < ACTION_MAX); j++)
+	{
+		for (i = ACTION_MAX-1; i > 0; i--)
+		{
+			p_ptr->previous_action[i] = p_ptr->previous_action[i-1];
+		}
+		p_ptr->previous_action[0] = 5;
+	}
+
+	/* The rest count */
+	if (p_ptr->resting > 0) p_ptr->resting -= n;
+
+	/* Count the turns */
+	playerturn += n;
+	turn += 10 * n;
+
+	/* Redraw */
+	p_ptr->update |= (PU_BONUS);
+	p_ptr->redraw |= (PR_HP | PR_VOICE | PR_STATE);
+	p_ptr->window |= (PW_INVEN | PW_EQUIP | PW_PLAYER_0);
+
+	/*** The things that happened in the last turn ***/
+
+	if (ident) ident_passive();
+
+	was_ghost = (bones_selector) ? TRUE : FALSE;
+	if (wanderer) (void)alloc_monster(TRUE, FALSE);
+	if (wraith) (void)alloc_monster(TRUE, TRUE);
+	if ((bones_selector) && (!(was_ghost))) ghost_challenge();
+}
+
+
 /*
  * Process the player
  *
@@ -2265,20 +2693,10 @@ static void process_player(void)
 		regenmana(regen_multiplier);
 	}
 
-	/* Various things interfere with healing */
-    if (p_ptr->food < PY_FOOD_STARVE) regen_multiplier = 0;
-	if (p_ptr->poisoned) regen_multiplier = 0;
-	if (p_ptr->cut) regen_multiplier = 0;
-
-	if (singing(SNG_ESTE))
-	{
-		regen_multiplier *= ability_bonus(S_SNG, SNG_ESTE);
-	}
-	
 	/* Regenerate Hit Points if needed */
 	if (p_ptr->chp < p_ptr->mhp)
 	{
-		regenhp(regen_multiplier);
+		regenhp(player_regen_multiplier());
 	}
 	
 	/*** Timeout Various Things ***/
@@ -2480,8 +2898,53 @@ static void process_player(void)
 	p_ptr->window |= (PW_INVEN | PW_EQUIP);
 	p_ptr->window |= (PW_COMBAT_ROLLS);
 
+	/* Take the rest of a long rest all at once if nothing can happen */
+	if (p_ptr->resting) rest_in_bulk();
+
+}
+
+/*
+ * The number of game turns to advance by: one, plus any following game
+ * turns in which nothing would happen.
+ *
+ * A game turn does nothing unless the player or a monster has enough energy
+ * to act in it, or "process_world()" has work to do (on every tenth game
+ * turn), so those turns can be skipped by handing out their energy all at
+ * once.  The turns that are played are exactly the same as before.
+ */
+static int game_turns_to_advance(void)
+{
+	int i, n;
+	int wait;
+
+	/* Wait until the next tenth game turn at the most */
+	wait = 10 - (int)(turn % 10);
+
+	/* The player */
+	n = (100 - p_ptr->energy + extract_energy[p_ptr->pspeed] - 1) /
+	    extract_energy[p_ptr->pspeed];
+	if (n < wait) wait = n;
+
+	/* The monsters */
+	for (i = mon_live_num - 1; (i >= 0) && (wait > 1); i--)
+	{
+		monster_type *m_ptr = &mon_list[mon_live[i]];
+
+		n = (100 - m_ptr->energy + extract_energy[m_ptr->mspeed] - 1) /
+		    extract_energy[m_ptr->mspeed];
+		if (n < wait) wait = n;
+	}
+
+	/* Always advance by at least one game turn */
+	if (wait < 1) wait = 1;
+
+	PROFILE_ADD(PROF_GAME_TURNS, wait);
+	PROFILE_ADD(PROF_IDLE_TURNS, wait - 1);
+
+	return (wait);
 }
 
+
 /*
  * Interact with the current dungeon level.
  *
@@ -2491,7 +2954,7 @@ static void process_player(void)
 static void dungeon(void)
 {
 	monster_type *m_ptr;
-	int i;
+	int i, n;
 
 	/* Hack -- enforce illegal panel */
 	p_ptr->wy = p_ptr->cur_map_hgt;
@@ -2675,14 +3138,10 @@ static void dungeon(void)
 		/* Hack -- Compact the monster list occasionally */
 		if (mon_cnt + 10 > MAX_MONSTERS) compact_monsters(20);
 
-		/* Hack -- Compress the monster list occasionally */
-		if (mon_cnt + 32 < MAX_MONSTERS) compact_monsters(0);
-
 		/* Hack -- Compact the object list occasionally */
 		if (o_cnt + 32 > z_info->o_max) compact_objects(64);
 
-		/* Hack -- Compress the object list occasionally */
-		if (o_cnt + 32 < o_max) compact_objects(0);
+		/* (The holes left by dead monsters and objects are reused directly) */
 
 
 		/*** Apply energy ***/
@@ -2703,7 +3162,9 @@ static void dungeon(void)
 				if (p_ptr->redraw) redraw_stuff();
 
 				/* Process the player */
+				PROFILE_START(PROF_PROCESS_PLAYER);
 				process_player();
+				PROFILE_STOP(PROF_PROCESS_PLAYER);
 			}
 
 		}
@@ -2780,24 +3241,24 @@ static void dungeon(void)
 		/* Handle "leaving" */
 		if (p_ptr->leaving) break;
 
+		/* Skip any game turns in which nothing would happen */
+		n = game_turns_to_advance();
+
 		/* Give the player some energy */
-		p_ptr->energy += extract_energy[p_ptr->pspeed];
+		p_ptr->energy += n * extract_energy[p_ptr->pspeed];
 
 		/* Give energy to all monsters */
-		for (i = mon_max - 1; i >= 1; i--)
+		for (i = mon_live_num - 1; i >= 0; i--)
 		{
 			/* Access the monster */
-			m_ptr = &mon_list[i];
-
-			/* Ignore "dead" monsters */
-			if (!m_ptr->r_idx) continue;
+			m_ptr = &mon_list[mon_live[i]];
 
 			/* Give this monster some energy */
-			m_ptr->energy += extract_energy[m_ptr->mspeed];
+			m_ptr->energy += n * extract_energy[m_ptr->mspeed];
 		}
 
 		/* Count game turns */
-		turn++;
+		turn += n;
 	}
 }
 
@@ -2891,6 +3352,7 @@ static void death_knowledge(void)
  */
 void play_game(bool new_game)
 {
+	u32b seed = 0;
     
 	/* Hack -- Increase "icky" depth */
 	character_icky++;
@@ -2944,8 +3406,6 @@ void play_game(bool new_game)
 	/* Init RNG */
 	if (Rand_quick)
 	{
-		u32b seed;
-
 		/* Basic seed */
 		seed = (time(NULL));
 
@@ -2956,6 +3416,9 @@ void play_game(bool new_game)
 
 #endif
 
+		/* Batch games and keypress logs can be replayed from their seed */
+		if (arg_batch || arg_replay) seed = arg_batch_seed;
+
 		/* Use the complex RNG */
 		Rand_quick = FALSE;
 
@@ -2963,6 +3426,9 @@ void play_game(bool new_game)
 		Rand_state_init(seed);
 	}
 
+	/* Record the keys of the game */
+	if (arg_keylog) keylog_record(arg_keylog, seed);
+
 	/* Roll new character */
 	if (new_game)
 	{
@@ -3045,6 +3511,9 @@ void play_game(bool new_game)
 	/* React to changes */
 	Term_xtra(TERM_XTRA_REACT, 0);
 
+	/* Benchmark level generation instead of playing (never returns) */
+	if (arg_gen_levels) generate_benchmark(arg_gen_levels);
+
 	/* Generate a dungeon level if needed */
 	if (!character_dungeon) generate_cave();
 
@@ -3070,6 +3539,9 @@ void play_game(bool new_game)
     // update player noise
     update_flow(p_ptr->py, p_ptr->px, FLOW_PLAYER_NOISE);
 
+    // batch games are played by the automaton from the start
+    if (arg_batch && !p_ptr->automaton) do_cmd_automaton();
+
 	// reset combat roll info
 	turns_since_combat = 0;
     
@@ -3196,6 +3668,12 @@ void play_game(bool new_game)
 
 	}
 
+	/* Batch games and replays end here, without a tombstone or savefile */
+	if (arg_batch || arg_replay) automaton_batch_end(NULL);
+
+	/* The recording ends with the game */
+	keylog_close();
+
 	/* Close stuff */
 	close_game();
 }
@@ -54,144 +54,165 @@ extern byte spell_desire_RF4[32][2];
 
 
 /* variable.c */
-char mini_screenshot_char[7][7];
-byte mini_screenshot_attr[7][7];
+extern GAME_LOCAL char mini_screenshot_char[7][7];
+extern GAME_LOCAL byte mini_screenshot_attr[7][7];
 extern cptr copyright;
 extern byte version_major;
 extern byte version_minor;
 extern byte version_patch;
 extern byte version_extra;
-extern byte sf_major;
-extern byte sf_minor;
-extern byte sf_patch;
-extern byte sf_extra;
-extern u32b sf_xtra;
-extern u32b sf_when;
-extern u16b sf_lives;
-extern u16b sf_saves;
+extern GAME_LOCAL byte sf_major;
+extern GAME_LOCAL byte sf_minor;
+extern GAME_LOCAL byte sf_patch;
+extern GAME_LOCAL byte sf_extra;
+extern GAME_LOCAL u32b sf_xtra;
+extern GAME_LOCAL u32b sf_when;
+extern GAME_LOCAL u16b sf_lives;
+extern GAME_LOCAL u16b sf_saves;
 extern bool arg_fiddle;
 extern bool arg_wizard;
 extern bool arg_sound;
 extern bool arg_graphics;
 extern bool arg_force_original;
 extern bool arg_force_roguelike;
-extern bool character_generated;
-extern bool character_dungeon;
-extern bool character_loaded;
-extern bool character_loaded_dead;
-extern bool character_saved;
-extern s16b character_icky;
-extern s16b character_xtra;
-extern u32b seed_randart;
-extern u32b seed_flavor;
-extern s16b num_repro;
-extern s16b object_level;
-extern s16b monster_level;
-extern char summon_kin_type;
-extern s32b turn;
-extern s32b playerturn;
+extern bool arg_batch;
+extern u32b arg_batch_seed;
+extern s32b arg_batch_turns;
+extern int arg_gen_levels;
+extern cptr arg_keylog;
+extern cptr arg_replay;
+extern GAME_LOCAL bool character_generated;
+extern GAME_LOCAL bool character_dungeon;
+extern GAME_LOCAL bool character_loaded;
+extern GAME_LOCAL bool character_loaded_dead;
+extern GAME_LOCAL bool character_saved;
+extern GAME_LOCAL s16b character_icky;
+extern GAME_LOCAL s16b character_xtra;
+extern GAME_LOCAL u32b seed_randart;
+extern GAME_LOCAL u32b seed_flavor;
+extern GAME_LOCAL s16b num_repro;
+extern GAME_LOCAL s16b object_level;
+extern GAME_LOCAL s16b monster_level;
+extern GAME_LOCAL char summon_kin_type;
+extern GAME_LOCAL s32b turn;
+extern GAME_LOCAL s32b playerturn;
 extern bool use_sound;
 extern int use_graphics;
-extern s16b image_count;
+extern GAME_LOCAL s16b image_count;
 extern bool use_bigtile;
 extern s16b signal_count;
-extern bool msg_flag;
-extern bool inkey_base;
-extern bool inkey_xtra;
-extern bool inkey_scan;
-extern bool inkey_flag;
-extern bool hide_cursor;
-extern byte object_generation_mode;
-extern bool shimmer_monsters;
-extern bool shimmer_objects;
-extern bool repair_mflag_mark;
-extern bool repair_mflag_show;
-extern s16b o_max;
-extern s16b o_cnt;
-extern s16b mon_max;
-extern s16b mon_cnt;
-extern byte feeling;
-extern bool do_feeling;
-extern s16b rating;
-extern bool good_item_flag;
-extern bool closing_flag;
+extern GAME_LOCAL bool msg_flag;
+extern GAME_LOCAL bool inkey_base;
+extern GAME_LOCAL bool inkey_xtra;
+extern GAME_LOCAL bool inkey_scan;
+extern GAME_LOCAL bool inkey_flag;
+extern GAME_LOCAL bool hide_cursor;
+extern GAME_LOCAL byte object_generation_mode;
+extern GAME_LOCAL bool shimmer_monsters;
+extern GAME_LOCAL bool shimmer_objects;
+extern GAME_LOCAL bool repair_mflag_mark;
+extern GAME_LOCAL bool repair_mflag_show;
+extern GAME_LOCAL s16b o_max;
+extern GAME_LOCAL s16b o_cnt;
+extern GAME_LOCAL s16b *o_free;
+extern GAME_LOCAL s16b o_free_num;
+extern GAME_LOCAL s16b mon_max;
+extern GAME_LOCAL s16b mon_cnt;
+extern GAME_LOCAL s16b *mon_live;
+extern GAME_LOCAL s16b mon_live_num;
+extern GAME_LOCAL s16b *mon_free;
+extern GAME_LOCAL s16b mon_free_num;
+extern GAME_LOCAL u16b *mon_gen;
+extern GAME_LOCAL byte feeling;
+extern GAME_LOCAL bool do_feeling;
+extern GAME_LOCAL s16b rating;
+extern GAME_LOCAL bool good_item_flag;
+extern GAME_LOCAL bool closing_flag;
 extern int player_uid;
 extern int player_euid;
 extern int player_egid;
-extern char savefile[1024];
+extern GAME_LOCAL char savefile[1024];
 extern s16b macro__num;
 extern cptr *macro__pat;
 extern cptr *macro__act;
-extern term *angband_term[ANGBAND_TERM_MAX];
+extern GAME_LOCAL term *angband_term[ANGBAND_TERM_MAX];
 extern char angband_term_name[ANGBAND_TERM_MAX][16];
 extern byte angband_color_table[256][4];
 extern const cptr angband_sound_name[MSG_MAX];
-extern int view_n;
-extern u16b *view_g;
-extern int temp_n;
-extern u16b *temp_g;
-extern byte *temp_y;
-extern byte *temp_x;
-extern u16b (*cave_info)[256];
-extern byte (*cave_feat)[MAX_DUNGEON_WID];
-extern s16b (*cave_light)[MAX_DUNGEON_WID];
-extern s16b (*cave_o_idx)[MAX_DUNGEON_WID];
-extern s16b (*cave_m_idx)[MAX_DUNGEON_WID];
+extern GAME_LOCAL int view_n;
+extern GAME_LOCAL u16b *view_g;
+extern GAME_LOCAL int temp_n;
+extern GAME_LOCAL u16b *temp_g;
+extern GAME_LOCAL byte *temp_y;
+extern GAME_LOCAL byte *temp_x;
+extern GAME_LOCAL u16b (*cave_info)[256];
+extern GAME_LOCAL byte (*cave_feat)[MAX_DUNGEON_WID];
+extern GAME_LOCAL s16b (*cave_light)[MAX_DUNGEON_WID];
+extern GAME_LOCAL s16b (*cave_o_idx)[MAX_DUNGEON_WID];
+extern GAME_LOCAL s16b (*cave_m_idx)[MAX_DUNGEON_WID];
 extern u32b mon_power_ave[MAX_DEPTH][CREATURE_TYPE_MAX];
 
 
-extern byte cave_cost[MAX_FLOWS][MAX_DUNGEON_HGT][MAX_DUNGEON_WID];
-extern byte (*cave_when)[MAX_DUNGEON_WID];
-extern int scent_when;
-extern byte flow_center_y[MAX_FLOWS];
-extern byte flow_center_x[MAX_FLOWS];
-extern byte update_center_y[MAX_FLOWS];
-extern byte update_center_x[MAX_FLOWS];
-extern s16b wandering_pause[MAX_FLOWS];
-
-
-extern s16b stealth_score;
-extern bool player_attacked;
-extern bool attacked_player;
+extern GAME_LOCAL byte_wid *cave_cost[MAX_FLOWS];
+extern GAME_LOCAL flow_class_type flow_class[MAX_FLOW_CLASSES];
+extern GAME_LOCAL u32b terrain_epoch;
+extern GAME_LOCAL byte flow_dirty_y[FLOW_DIRTY_MAX];
+extern GAME_LOCAL byte flow_dirty_x[FLOW_DIRTY_MAX];
+extern GAME_LOCAL u32b flow_epoch[MAX_FLOWS];
+extern GAME_LOCAL byte (*cave_when)[MAX_DUNGEON_WID];
+extern GAME_LOCAL int scent_when;
+extern GAME_LOCAL byte flow_center_y[MAX_FLOWS];
+extern GAME_LOCAL byte flow_center_x[MAX_FLOWS];
+extern GAME_LOCAL byte update_center_y[MAX_FLOWS];
+extern GAME_LOCAL byte update_center_x[MAX_FLOWS];
+extern GAME_LOCAL s16b wandering_pause[MAX_FLOWS];
+
+
+extern GAME_LOCAL s16b stealth_score;
+extern GAME_LOCAL bool player_attacked;
+extern GAME_LOCAL bool attacked_player;
 extern maxima *z_info;
-extern object_type *o_list;
-extern monster_type *mon_list;
-extern monster_lore *l_list;
-extern object_type *inventory;
-extern s16b alloc_kind_size;
-extern alloc_entry *alloc_kind_table;
-extern s16b alloc_ego_size;
-extern alloc_entry *alloc_ego_table;
-extern s16b alloc_race_size;
-extern alloc_entry *alloc_race_table;
+extern GAME_LOCAL object_type *o_list;
+extern GAME_LOCAL monster_type *mon_list;
+extern GAME_LOCAL monster_lore *l_list;
+extern GAME_LOCAL object_type *inventory;
+extern GAME_LOCAL s16b alloc_kind_size;
+extern GAME_LOCAL alloc_entry *alloc_kind_table;
+extern GAME_LOCAL u32b alloc_kind_version;
+extern GAME_LOCAL s16b alloc_ego_size;
+extern GAME_LOCAL alloc_entry *alloc_ego_table;
+extern GAME_LOCAL s16b alloc_race_size;
+extern GAME_LOCAL alloc_entry *alloc_race_table;
+extern GAME_LOCAL u32b alloc_race_version;
 extern byte misc_to_attr[256];
 extern char misc_to_char[256];
 extern byte tval_to_attr[128];
 extern char macro_buffer[1024];
 extern cptr keymap_act[KEYMAP_MODES][256];
-extern const player_sex *sp_ptr;
-extern const player_race *rp_ptr;
-extern player_house *hp_ptr;
-extern player_other *op_ptr;
-extern player_type *p_ptr;
+extern GAME_LOCAL const player_sex *sp_ptr;
+extern GAME_LOCAL const player_race *rp_ptr;
+extern GAME_LOCAL player_house *hp_ptr;
+extern GAME_LOCAL player_other player_other_body;
+extern GAME_LOCAL player_type player_type_body;
 extern vault_type *v_info;
 extern char *v_name;
 extern char *v_text;
 extern feature_type *f_info;
 extern char *f_name;
 extern char *f_text;
-extern object_kind *k_info;
+extern GAME_LOCAL object_kind *k_info;
 extern char *k_name;
 extern char *k_text;
+extern index_table k_index;
 extern ability_type *b_info;
 extern char *b_name;
 extern char *b_text;
-extern artefact_type *a_info;
+extern GAME_LOCAL artefact_type *a_info;
 extern char *a_text;
-extern ego_item_type *e_info;
+extern GAME_LOCAL ego_item_type *e_info;
 extern char *e_name;
 extern char *e_text;
-extern monster_race *r_info;
+extern GAME_LOCAL monster_race *r_info;
 extern char *r_name;
 extern char *r_text;
 extern player_race *p_info;
@@ -207,16 +228,16 @@ extern char *flavor_name;
 extern char *flavor_text;
 extern names_type *n_info;
 
-extern combat_roll combat_rolls[2][MAX_COMBAT_ROLLS];
-extern int combat_number;
-extern int combat_number_old;
-extern int turns_since_combat;
-extern char combat_roll_special_char;
-extern byte combat_roll_special_attr;
+extern GAME_LOCAL combat_roll combat_rolls[2][MAX_COMBAT_ROLLS];
+extern GAME_LOCAL int combat_number;
+extern GAME_LOCAL int combat_number_old;
+extern GAME_LOCAL int turns_since_combat;
+extern GAME_LOCAL char combat_roll_special_char;
+extern GAME_LOCAL byte combat_roll_special_attr;
 
-extern bool project_path_ignore;
-extern int project_path_ignore_y;
-extern int project_path_ignore_x;
+extern GAME_LOCAL bool project_path_ignore;
+extern GAME_LOCAL int project_path_ignore_y;
+extern GAME_LOCAL int project_path_ignore_x;
 
 extern cptr ANGBAND_SYS;
 extern cptr ANGBAND_GRAF;
@@ -233,32 +254,32 @@ extern cptr ANGBAND_DIR_PREF;
 extern cptr ANGBAND_DIR_USER;
 extern cptr ANGBAND_DIR_XTRA;
 extern cptr ANGBAND_DIR_SCRIPT;
-extern bool item_tester_full;
-extern byte item_tester_tval;
-extern bool (*item_tester_hook)(const object_type*);
-extern bool (*ang_sort_comp)(const void *u, const void *v, int a, int b);
-extern void (*ang_sort_swap)(void *u, void *v, int a, int b);
-extern bool (*get_mon_num_hook)(int r_idx);
-extern bool (*get_obj_num_hook)(int k_idx);
-extern void (*object_info_out_flags)(const object_type *o_ptr, u32b *f1, u32b *f2, u32b *f3);
+extern GAME_LOCAL bool item_tester_full;
+extern GAME_LOCAL byte item_tester_tval;
+extern GAME_LOCAL bool (*item_tester_hook)(const object_type*);
+extern GAME_LOCAL bool (*ang_sort_comp)(const void *u, const void *v, int a, int b);
+extern GAME_LOCAL void (*ang_sort_swap)(void *u, void *v, int a, int b);
+extern GAME_LOCAL bool (*get_mon_num_hook)(int r_idx);
+extern GAME_LOCAL bool (*get_obj_num_hook)(int k_idx);
+extern GAME_LOCAL void (*object_info_out_flags)(const object_type *o_ptr, u32b *f1, u32b *f2, u32b *f3);
 extern FILE *text_out_file;
-extern void (*text_out_hook)(byte a, cptr str);
-extern int text_out_wrap;
-extern int text_out_indent;
+extern GAME_LOCAL void (*text_out_hook)(byte a, cptr str);
+extern GAME_LOCAL int text_out_wrap;
+extern GAME_LOCAL int text_out_indent;
 extern bool use_transparency;
-extern char notes_buffer[NOTES_LENGTH];
-extern byte recent_failed_thefts;
-extern autoinscription* inscriptions;
-extern u16b inscriptionsCount;
-extern byte num_trap_on_level;
-extern byte bones_selector;
-extern int r_ghost;
-extern char ghost_name[80];
-extern char g_vault_name[80];
-extern bool waiting_for_command;
-extern bool skill_gain_in_progress;
-extern bool save_game_quietly;
-extern bool stop_stealth_mode;
+extern GAME_LOCAL char notes_buffer[NOTES_LENGTH];
+extern GAME_LOCAL byte recent_failed_thefts;
+extern GAME_LOCAL autoinscription* inscriptions;
+extern GAME_LOCAL u16b inscriptionsCount;
+extern GAME_LOCAL byte num_trap_on_level;
+extern GAME_LOCAL byte bones_selector;
+extern GAME_LOCAL int r_ghost;
+extern GAME_LOCAL char ghost_name[80];
+extern GAME_LOCAL char g_vault_name[80];
+extern GAME_LOCAL bool waiting_for_command;
+extern GAME_LOCAL bool skill_gain_in_progress;
+extern GAME_LOCAL bool save_game_quietly;
+extern GAME_LOCAL bool stop_stealth_mode;
 extern bool use_background_colors;
 
 
@@ -273,11 +294,14 @@ extern bool gain_skills(void);
 
 /* automaton.c */
 extern void do_cmd_automaton(void);
+extern void automaton_batch_end(cptr result);
 
 /* cave.c */
 extern int distance(int y1, int x1, int y2, int x2);
 extern int distance_squared(int y1, int x1, int y2, int x2);
 extern bool los(int y1, int x1, int y2, int x2);
+extern bool los_to_player(int y, int x);
+extern bool los_from_player(int y, int x);
 extern void random_unseen_floor(int *ry, int *rx);
 extern bool no_light(void);
 extern bool seen_by_keen_senses(int y, int x);
@@ -294,9 +318,19 @@ extern void display_map(int *cy, int *cx);
 extern void do_cmd_view_map(void);
 extern errr vinfo_init(void);
 extern void forget_view(void);
+extern void wipe_view_history(void);
+extern void wipe_los_cache(void);
 extern void update_view(void);
 extern int flow_dist(int which_flow, int y, int x);
+extern int flow_fill(int which_flow, int cy, int cx, int (*cost_hook)(int y, int x, int dist, void *data), void *data);
+extern bool flow_repair(int which_flow, int (*cost_hook)(int y, int x, int dist, void *data), void *data,
+                        void (*reset)(int y, int x));
+extern void release_flow(int which_flow);
+extern void wipe_flows(void);
+extern void free_flows(void);
 extern void update_flow(int cy, int cx, int which_flow);
+extern void repair_flow(int which_flow);
+extern int update_monster_flow(monster_type *m_ptr);
 extern void update_smell(void);
 extern void map_area(void);
 extern void wiz_light(void);
@@ -417,7 +451,7 @@ extern void py_steal(int y, int x);
 
 
 /* cmd4.c */
-extern object_type *smith_o_ptr;
+extern GAME_LOCAL object_type smith_o_body;
 extern void do_cmd_redraw(void);
 extern void options_birth_menu(bool adult);
 extern void do_cmd_character_sheet(void);
@@ -425,6 +459,8 @@ extern void do_cmd_change_song(void);
 extern int ability_index(int skilltype, int abilitynum);
 extern int elf_bane_bonus(monster_type *m_ptr);
 extern char *bane_name[];
+extern int bane_bonus_aux(void);
+extern u32b bane_race_flag(void);
 extern int bane_bonus(monster_type *m_ptr);
 extern int spider_bane_bonus(void);
 extern void do_cmd_ability_screen(void);
@@ -472,6 +508,8 @@ extern void pseudo_id(object_type *o_ptr);
 extern void pseudo_id_everything(void);
 extern void id_known_specials(void);
 extern void id_everything(void);
+extern int regen_turns(int turn_number, int max, int regen_period, int amount);
+extern int player_regen_multiplier(void);
 extern void play_game(bool new_game);
 
 /* files.c */
@@ -517,11 +555,16 @@ extern void place_monster_by_flag(int y, int x, int flagset, u32b f, bool allow_
 extern void place_random_stairs(int y, int x);
 extern byte get_nest_theme(int nestlevel);
 extern byte get_pit_theme(int pitlevel);
+extern bool player_passable(int y, int x, bool ignore_rubble);
+extern int label_access(s16b label[MAX_DUNGEON_HGT][MAX_DUNGEON_WID], int y0, int x0, bool ignore_rubble);
 extern void generate_cave(void);
+extern void generate_benchmark(int num);
 
 /* init2.c */
 extern void init_file_paths(char *path);
 extern void display_introduction(void);
+extern void init_game_state(void);
+extern void cleanup_game_state(void);
 extern void init_angband(void);
 extern void autoinscribe_clean(void);
 extern void autoinscribe_init(void);
@@ -554,11 +597,15 @@ extern int adj_mon_count(int y, int x);
 extern int get_scent(int y, int x);
 extern bool cave_exist_mon(monster_race *r_ptr, int y, int x, bool occupied_ok, bool can_dig);
 extern int cave_passable_mon(monster_type *m_ptr, int y, int x, bool *bash);
+extern int cave_passable_occupant(monster_type *m_ptr, int y, int x);
+extern int cave_passable_terrain(monster_type *m_ptr, int y, int x, int move_chance, bool *bash);
 extern void tell_allies(int y, int x, u32b flag);
 extern void process_monsters(s16b minimum_energy);
 extern void calc_morale(monster_type *m_ptr);
 extern void calc_stance(monster_type *m_ptr);
 extern void monster_perception(bool player_centered, bool main_roll, int difficulty);
+extern int quiet_perception_gather(int difficulty);
+extern bool quiet_perception_roll(int num, int difficulty);
 
 /* monster1.c */
 extern void describe_monster(int r_idx, bool spoilers);
@@ -572,6 +619,9 @@ extern void delete_monster_idx(int i);
 extern void delete_monster(int y, int x);
 extern void compact_monsters(int size);
 extern void wipe_mon_list(void);
+extern s16b mon_live_prev(int m_idx);
+extern u32b mon_handle(int m_idx);
+extern s16b mon_handle_idx(u32b handle);
 extern s16b mon_pop(void);
 extern errr get_mon_num_prep(void);
 extern s16b get_mon_num(int level, bool special, bool allow_non_smart, bool vault);
@@ -642,6 +692,7 @@ extern s16b o_pop(void);
 extern object_type* get_first_object(int y, int x);
 extern object_type* get_next_object(const object_type *o_ptr);
 extern errr get_obj_num_prep(void);
+extern int alloc_table_find(const alloc_entry *table, int size, long value);
 extern s16b get_obj_num(int level);
 extern void object_known(object_type *o_ptr);
 extern void object_aware(object_type *o_ptr);
@@ -649,6 +700,7 @@ extern void object_tried(object_type *o_ptr);
 extern s32b object_value(const object_type *o_ptr);
 extern bool object_similar(const object_type *o_ptr, const object_type *j_ptr);
 extern void object_absorb(object_type *o_ptr, object_type *j_ptr);
+extern void index_kinds(void);
 extern s16b lookup_kind(int tval, int sval);
 extern void object_wipe(object_type *o_ptr);
 extern void object_copy(object_type *o_ptr, const object_type *j_ptr);
@@ -684,7 +736,7 @@ extern void inven_drop(int item, int amt);
 extern void combine_pack(void);
 extern void reorder_pack(bool display_message);
 extern void steal_object_from_monster(int y, int x);
-extern byte allow_altered_inventory;
+extern GAME_LOCAL byte allow_altered_inventory;
 
 /* randart.c */
 extern void make_random_name(char *random_name, size_t max);
@@ -822,7 +874,7 @@ extern bool mass_identify(int rad);
 
 
 /* squelch.c */
-extern byte squelch_level[SQUELCH_BYTES];
+extern GAME_LOCAL byte squelch_level[SQUELCH_BYTES];
 extern int do_cmd_autoinscribe_item(s16b k_idx);
 extern void do_cmd_squelch_autoinsc(void);
 extern int squelch_itemp(object_type *o_ptr, byte feeling, bool fullid);
@@ -858,6 +910,7 @@ extern errr fd_lock(int fd, int what);
 extern errr fd_seek(int fd, long n);
 extern errr fd_read(int fd, char *buf, size_t n);
 extern errr fd_write(int fd, cptr buf, size_t n);
+extern errr fd_sync(int fd);
 extern errr fd_close(int fd);
 extern errr check_modification_date(int fd, cptr template_file);
 extern void text_to_ascii(char *buf, size_t len, cptr str);
@@ -869,6 +922,18 @@ extern errr macro_free(void);
 extern errr macro_trigger_free(void);
 extern void flush(void);
 extern void flush_fail(void);
+extern void keylog_record(cptr name, u32b seed);
+extern errr keylog_replay(cptr name, bool *batch, u32b *seed, bool *loaded);
+extern void keylog_close(void);
+extern u32b state_hash(void);
+extern double profile_clock(void);
+#ifdef ALLOW_PROFILE
+extern void profile_start(int n);
+extern void profile_stop(int n);
+extern void profile_count(int n);
+extern void profile_add(int n, long x);
+extern void profile_report(FILE *fff);
+#endif /* ALLOW_PROFILE */
 extern char inkey(void);
 extern void bell(cptr reason);
 extern void sound(int val);
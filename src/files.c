@@ -3326,7 +3326,7 @@ void do_cmd_save_game(void)
 /*
  * Hack - save the time of death
  */
-static time_t death_time = (time_t)0;
+static GAME_LOCAL time_t death_time = (time_t)0;
 
 
 /*
@@ -3432,7 +3432,7 @@ static void death_examine(void)
 /*
  * The "highscore" file descriptor, if available.
  */
-static int highscore_fd = -1;
+static GAME_LOCAL int highscore_fd = -1;
 
 /*
  * Seek score 'i' in the highscore file
@@ -3990,7 +3990,7 @@ void display_scores(int from, int to)
 /*
  * Hack - save index of player's high score
  */
-static int score_idx = -1;
+static GAME_LOCAL int score_idx = -1;
 
 
 /*
@@ -5278,6 +5278,9 @@ static void handle_signal_abort(int sig)
 	/* Nothing to save, just quit */
 	if (!character_generated || character_saved) quit(NULL);
 
+	/* Batch games and replays report the bug rather than saving */
+	if (arg_batch || arg_replay) automaton_batch_end("crashed");
+
 
 	/* Clear the bottom line */
 	Term_erase(0, 23, 255);
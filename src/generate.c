@@ -100,7 +100,7 @@
 #define WALL_MAX	500
 #define TUNN_MAX	900
 
-bool allow_uniques;
+GAME_LOCAL bool allow_uniques;
 
 
 /*
@@ -109,6 +109,46 @@ bool allow_uniques;
 #define ROOM_MAX	12
 #define ROOM_MIN     2
 
+
+/*
+ * Reasons for a level generation attempt to fail
+ */
+#define GEN_FAIL_FORGE			0	/* Couldn't force a forge */
+#define GEN_FAIL_ROOMS			1	/* Not enough rooms */
+#define GEN_FAIL_TUNNELS		2	/* Couldn't connect the rooms */
+#define GEN_FAIL_PLACE			3	/* Couldn't place rubble or the player */
+#define GEN_FAIL_CONNECTIVITY	4	/* Failed "check_connectivity()" */
+#define GEN_FAIL_OBJECTS		5	/* Too many objects */
+#define GEN_FAIL_MONSTERS		6	/* Too many monsters */
+#define GEN_FAIL_MAX			7
+
+/*
+ * Statistics on level generation, only kept while benchmarking it
+ * (see "generate_benchmark()")
+ */
+typedef struct gen_stats_type gen_stats_type;
+
+struct gen_stats_type
+{
+	long attempts;					/* Calls to "cave_gen()" and the like */
+	long fail[GEN_FAIL_MAX];		/* Failed attempts, by reason */
+
+	long rooms[ROOM_MAX];			/* Rooms built, by type */
+	long rooms_failed[ROOM_MAX];	/* Rooms that didn't fit, by type */
+	long vaults_failed;				/* Vaults that "build_vault()" refused */
+
+	long monsters;					/* Monsters on the finished levels */
+	long objects;					/* Objects on the finished levels */
+};
+
+static GAME_LOCAL gen_stats_type *gen_stats;
+
+/*
+ * Note a failed attempt in the statistics (if they are being kept)
+ */
+#define GEN_FAILED(N) \
+	((void)(gen_stats && gen_stats->fail[N]++))
+
 /*
  * Simple structure to hold a map location
  */
@@ -162,14 +202,14 @@ struct dun_data
 /*
  * Dungeon generation data -- see "cave_gen()"
  */
-static dun_data *dun;
+static GAME_LOCAL dun_data *dun;
 
 /*
  * Array[DUNGEON_HGT][DUNGEON_WID]. 
  * Each corridor square it is marked for each room that it connects.
  */
-int cave_corridor1[MAX_DUNGEON_HGT][MAX_DUNGEON_WID];
-int cave_corridor2[MAX_DUNGEON_HGT][MAX_DUNGEON_WID];
+GAME_LOCAL int cave_corridor1[MAX_DUNGEON_HGT][MAX_DUNGEON_WID];
+GAME_LOCAL int cave_corridor2[MAX_DUNGEON_HGT][MAX_DUNGEON_WID];
 
 
 /* determines whether the player can pass through a given feature */
@@ -190,31 +230,98 @@ bool player_passable(int y, int x, bool ignore_rubble)
 }
 
 
-/* floodfills access through the dungeon, marking all accessible squares with TRUE */
-void flood_access(int y, int x, int access_array[MAX_DUNGEON_HGT][MAX_DUNGEON_WID], bool ignore_rubble)
-{
-	/* first check the map bounds */
-	if ((y < 0) || (y > p_ptr->cur_map_hgt) || (x < 0) || (x > p_ptr->cur_map_wid))
-		return;
-	
-	access_array[y][x] = TRUE;
-	if (player_passable(y-1, x-1, ignore_rubble) && (access_array[y-1][x-1] == FALSE))
-		flood_access(y-1, x-1, access_array, ignore_rubble);
-	if (player_passable(y-1, x, ignore_rubble) && (access_array[y-1][x] == FALSE))
-		flood_access(y-1, x, access_array, ignore_rubble);
-	if (player_passable(y-1, x+1, ignore_rubble) && (access_array[y-1][x+1] == FALSE))
-		flood_access(y-1, x+1, access_array, ignore_rubble);
-	if (player_passable(y, x-1, ignore_rubble) && (access_array[y][x-1] == FALSE))
-		flood_access(y, x-1, access_array, ignore_rubble);
-	if (player_passable(y, x+1, ignore_rubble) && (access_array[y][x+1] == FALSE))
-		flood_access(y, x+1, access_array, ignore_rubble);
-	if (player_passable(y+1, x-1, ignore_rubble) && (access_array[y+1][x-1] == FALSE))
-		flood_access(y+1, x-1, access_array, ignore_rubble);
-	if (player_passable(y+1, x, ignore_rubble) && (access_array[y+1][x] == FALSE))
-		flood_access(y+1, x, access_array, ignore_rubble);
-	if (player_passable(y+1, x+1, ignore_rubble) && (access_array[y+1][x+1] == FALSE))
-		flood_access(y+1, x+1, access_array, ignore_rubble);
-	return;
+/*
+ * Find the root of the set holding "i" in a union-find forest
+ * (halving the path to it on the way)
+ */
+static int uf_find(int *parent, int i)
+{
+	while (parent[i] != i)
+	{
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+
+	return (i);
+}
+
+
+/*
+ * Join the sets holding "i" and "j" in a union-find forest
+ *
+ * The lower root always wins, so each root is the first member of its set.
+ */
+static void uf_join(int *parent, int i, int j)
+{
+	i = uf_find(parent, i);
+	j = uf_find(parent, j);
+
+	if (i < j) parent[j] = i;
+	else       parent[i] = j;
+}
+
+
+/*
+ * Label the pieces of the map that the player can move around in (see
+ * "player_passable()"), where a move can go in any of the eight directions.
+ *
+ * The map is scanned once, row by row, joining each passable grid to the
+ * passable grids next to it that have already been scanned (the one to its
+ * left and the three above it), and then each piece is numbered from 1 in
+ * the order it is first met.  Impassable grids are labelled 0, except for
+ * the grid (y0, x0), which is always counted as passable (it is where the
+ * player stands).
+ *
+ * Returns the number of pieces.
+ */
+int label_access(s16b label[MAX_DUNGEON_HGT][MAX_DUNGEON_WID], int y0, int x0, bool ignore_rubble)
+{
+	static GAME_LOCAL int parent[GRID(MAX_DUNGEON_HGT, 0)];
+	int y, x, i;
+	int pieces = 0;
+
+	for (y = 0; y < p_ptr->cur_map_hgt; y++)
+	{
+		for (x = 0; x < p_ptr->cur_map_wid; x++)
+		{
+			i = GRID(y, x);
+
+			if (!player_passable(y, x, ignore_rubble) && ((y != y0) || (x != x0)))
+			{
+				label[y][x] = 0;
+				continue;
+			}
+
+			label[y][x] = 1;
+			parent[i] = i;
+
+			/* Join the neighbours already scanned */
+			if ((x > 0) && label[y][x-1]) uf_join(parent, i, GRID(y, x-1));
+
+			if (y > 0)
+			{
+				if ((x > 0) && label[y-1][x-1]) uf_join(parent, i, GRID(y-1, x-1));
+				if (label[y-1][x]) uf_join(parent, i, GRID(y-1, x));
+				if ((x + 1 < p_ptr->cur_map_wid) && label[y-1][x+1]) uf_join(parent, i, GRID(y-1, x+1));
+			}
+		}
+	}
+
+	/* Number the pieces (each root comes before the rest of its piece) */
+	for (y = 0; y < p_ptr->cur_map_hgt; y++)
+	{
+		for (x = 0; x < p_ptr->cur_map_wid; x++)
+		{
+			if (!label[y][x]) continue;
+
+			i = uf_find(parent, GRID(y, x));
+
+			if (i == GRID(y, x)) label[y][x] = ++pieces;
+			else                 label[y][x] = label[GRID_Y(i)][GRID_X(i)];
+		}
+	}
+
+	return (pieces);
 }
 
 
@@ -241,50 +348,38 @@ void label_rooms(void)
 	}	
 }
 
-// floodfills access through the *graph* of the dungeon
-void flood_piece(int n, int piece_num)
+/*
+ * Cut the dungeon up into pieces of rooms that are connected to each other,
+ * numbering the pieces from 1 in the order of their first rooms.
+ *
+ * Returns the number of pieces.
+ */
+int dungeon_pieces(void)
 {
-	int i;
-	
-	dun->piece[n] = piece_num;
-			
+	int parent[CENT_MAX];
+	int pieces = 0;
+	int i, j;
+
+	for (i = 0; i < dun->cent_n; i++) parent[i] = i;
+
 	for (i = 0; i < dun->cent_n; i++)
 	{
-		if (dun->connection[n][i] && (dun->piece[i] == 0))
+		for (j = i + 1; j < dun->cent_n; j++)
 		{
-			flood_piece(i, piece_num);
+			if (dun->connection[i][j]) uf_join(parent, i, j);
 		}
 	}
-	return;
-}
 
-int dungeon_pieces(void)
-{
-	int piece_num;
-	int i;
-	
-	// first reset the pieces
+	/* Each root is the first room of its piece */
 	for (i = 0; i < dun->cent_n; i++)
 	{
-		dun->piece[i] = 0;
-	}
-	
-	for (piece_num = 1; piece_num <= dun->cent_n; piece_num++)
-	{
-		// find the next room that doesn't belong to a piece
-		for (i = 0; (i < dun->cent_n) && (dun->piece[i] != 0); i++);
-		
-		if (i == dun->cent_n)
-		{
-			break;
-		}
-		else
-		{
-			flood_piece(i, piece_num);
-		}
+		j = uf_find(parent, i);
+
+		if (j == i) dun->piece[i] = ++pieces;
+		else        dun->piece[i] = dun->piece[j];
 	}
-	
-	return (piece_num - 1);
+
+	return (pieces);
 }
 
 
@@ -1640,33 +1735,19 @@ static bool place_rubble_player(void)
 
 bool check_connectivity(void)
 {
-	int cave_access[MAX_DUNGEON_HGT][MAX_DUNGEON_WID];
+	s16b label[MAX_DUNGEON_HGT][MAX_DUNGEON_WID];
+	int py = p_ptr->py;
+	int px = p_ptr->px;
 	int y, x;
 
-	// Reset the array used for checking connectivity
-	for (y = 0; y < p_ptr->cur_map_hgt; y++)	
-		for (x = 0; x < p_ptr->cur_map_wid; x++)
-			cave_access[y][x] = FALSE;
-	
 	// Make sure entire dungeon is connected (ignoring rubble)
-	flood_access(p_ptr->py, p_ptr->px, cave_access, TRUE);
-	for (y = 0; y < p_ptr->cur_map_hgt; y++)	
-		for (x = 0; x < p_ptr->cur_map_wid; x++)
-			if (player_passable(y,x,TRUE) && (cave_access[y][x] == FALSE))
-			{
-				return (FALSE);
-			}
+	if (label_access(label, py, px, TRUE) > 1) return (FALSE);
 
-	// Reset the array used for checking connectivity
-	for (y = 0; y < p_ptr->cur_map_hgt; y++)	
-		for (x = 0; x < p_ptr->cur_map_wid; x++)
-			cave_access[y][x] = FALSE;
-	
 	// Make sure player can reach stairs without going through rubble
-	flood_access(p_ptr->py, p_ptr->px, cave_access, FALSE);
+	(void)label_access(label, py, px, FALSE);
 	for (y = 0; y < p_ptr->cur_map_hgt; y++)	
 		for (x = 0; x < p_ptr->cur_map_wid; x++)
-			if ((cave_access[y][x] == TRUE) && cave_stair_bold(y,x))
+			if ((label[y][x] == label[py][px]) && cave_stair_bold(y,x))
 			{
 				return (TRUE);
 			}
@@ -2196,12 +2277,14 @@ static bool build_vault(int y0, int x0, vault_type *v_ptr, bool flip_d)
 			if ((*t == 'W') && (p_ptr->depth > 12))
 			{
 				//msg_print("Skipped a barrow wight vault.");
+				if (gen_stats) gen_stats->vaults_failed++;
 				return (FALSE);
 			}
 
             // chasms can't occur at 950 ft
 			if ((*t == '7') && (p_ptr->depth >= MORGOTH_DEPTH - 1))
 			{
+				if (gen_stats) gen_stats->vaults_failed++;
 				return (FALSE);
 			}
 		}
@@ -3155,6 +3238,7 @@ static bool build_type10(int y0, int x0)
 static bool room_build(int typ)
 {
 	int y, x;
+	bool made;
 
 	if (dun->cent_n >= CENT_MAX)
 	{
@@ -3169,40 +3253,29 @@ static bool room_build(int typ)
 	{
 		/* Build an appropriate room */
 		// Greater Vault
-		case 8: build_type8(y, x); break;
+		case 8: made = build_type8(y, x); break;
 		// Lesser Vault
-		case 7: build_type7(y, x); break;
+		case 7: made = build_type7(y, x); break;
 		// Least Vault
-		case 6:
-		{
-			if (!build_type6(y, x))
-			{
-				return (FALSE);
-			}
-			break;
-		}
+		case 6: made = build_type6(y, x); break;
 		// Cross Room
-		case 2:
-		{
-			if (!build_type2(y, x))
-			{
-				return (FALSE);
-			}
-			break;
-		}
+		case 2: made = build_type2(y, x); break;
 		// Normal Room
-		case 1: 
-		{
-			if (!build_type1(y, x))
-			{
-				return (FALSE);
-			}
-			break;
-		}
+		case 1: made = build_type1(y, x); break;
 		/* Paranoia */
 		default: return (FALSE);
 	}
 
+	/* Statistics */
+	if (gen_stats)
+	{
+		if (made) gen_stats->rooms[typ]++;
+		else      gen_stats->rooms_failed[typ]++;
+	}
+
+	/* Hack -- vaults that don't fit are not failures */
+	if (!made && (typ != 7) && (typ != 8)) return (FALSE);
+
 	/* Success */
 	return (TRUE);
 }
@@ -3332,6 +3405,7 @@ static bool cave_gen(void)
 			p_ptr->force_forge = FALSE;
 
 			if (cheat_room) msg_format("failed.");
+			GEN_FAILED(GEN_FAIL_FORGE);
 
 			return (FALSE);
 		}
@@ -3385,6 +3459,7 @@ static bool cave_gen(void)
 	if (dun->cent_n < ROOM_MIN)
 	{
 		if (cheat_room) msg_format("Not enough rooms.");
+		GEN_FAILED(GEN_FAIL_ROOMS);
 		return (FALSE);
 	}
 
@@ -3393,6 +3468,7 @@ static bool cave_gen(void)
 	if (!connect_rooms_stairs())
 	{
 		if (cheat_room) msg_format("Couldn't connect the rooms.");
+		GEN_FAILED(GEN_FAIL_TUNNELS);
 		return (FALSE);
 	}
 	
@@ -3413,6 +3489,7 @@ static bool cave_gen(void)
 	if (!place_rubble_player())
 	{
 		if (cheat_room) msg_format("Couldn't place, rubble, or player.");
+		GEN_FAILED(GEN_FAIL_PLACE);
 		return (FALSE);
 	}
 
@@ -3420,6 +3497,7 @@ static bool cave_gen(void)
 	if (!check_connectivity())
 	{
 		if (cheat_room) msg_format("Failed connectivity.");
+		GEN_FAILED(GEN_FAIL_CONNECTIVITY);
 		return (FALSE);
 	}
 	
@@ -3693,12 +3771,24 @@ void unring_a_bell(void)
  *
  * Hack -- regenerate any "overflow" levels
  *
+ * Each attempt draws its level and object numbers from streams split off the
+ * level stream (see "Rand_split()"), so attempt "n" makes the same level
+ * whatever the failed attempts before it used up, and the level chosen is
+ * simply the first good one.  The object stream is left as it was.
+ *
  * Note that this function resets "cave_feat" and "cave_info" directly.
  */
 void generate_cave(void)
 {
 	int y, x, num, i;
 
+	u16b old_stream = Rand_stream;
+
+	u32b level_state[RAND_WORDS];
+	u32b object_state[RAND_WORDS];
+
+	PROFILE_START(PROF_GENERATE_CAVE);
+
 	/* The dungeon is not ready */
 	character_dungeon = FALSE;
 
@@ -3721,6 +3811,13 @@ void generate_cave(void)
     // reset the forced skipping of next turn (a bit rough to miss first turn if you fell down)
     p_ptr->skip_next_turn = FALSE;
 
+	/* Levels have their own random numbers */
+	Rand_stream = RAND_STREAM_LEVEL;
+
+	/* Keep the streams that the attempts are split from */
+	C_COPY(level_state, Rand_state[RAND_STREAM_LEVEL], RAND_WORDS, u32b);
+	C_COPY(object_state, Rand_state[RAND_STREAM_OBJECT], RAND_WORDS, u32b);
+
 	/* Generate num is increased below*/
 	for (num = 0; TRUE;)
 	{
@@ -3728,11 +3825,25 @@ void generate_cave(void)
 
 		cptr why = NULL;
 
+		/* This attempt's own random numbers */
+		Rand_split(level_state, Rand_state[RAND_STREAM_LEVEL]);
+		Rand_split(level_state, Rand_state[RAND_STREAM_OBJECT]);
+
+		PROFILE_COUNT(PROF_LEVEL_ATTEMPTS);
+		if (gen_stats) gen_stats->attempts++;
+
 		/* Reset */
 		o_max = 1;
 		mon_max = 1;
 		feeling = 0;
 
+		/* No flows yet */
+		wipe_flows();
+
+		/* Nothing has been seen yet */
+		wipe_view_history();
+		wipe_los_cache();
+
 		/* Start with a blank cave */
 		for (y = 0; y < MAX_DUNGEON_HGT; y++)
 		{
@@ -3750,11 +3861,6 @@ void generate_cave(void)
 				/* No monsters */
 				cave_m_idx[y][x] = 0;
 
-				for (i = 0; i < MAX_FLOWS; i++)
-				{
-					cave_cost[i][y][x] = FLOW_MAX_DIST;
-				}
-
 				cave_when[y][x] = 0;
 
 			}
@@ -3867,6 +3973,7 @@ void generate_cave(void)
 			{
 				/* Message */
 				why = "too many objects";
+				GEN_FAILED(GEN_FAIL_OBJECTS);
 
 				/* Message */
 				okay = FALSE;
@@ -3877,6 +3984,7 @@ void generate_cave(void)
 			{
 				/* Message */
 				why = "too many monsters";
+				GEN_FAILED(GEN_FAIL_MONSTERS);
 
 				/* Message */
 				okay = FALSE;
@@ -3919,10 +4027,180 @@ void generate_cave(void)
 			}
 		}
 	}
-	
 
+	/* Back to the previous random numbers */
+	C_COPY(Rand_state[RAND_STREAM_LEVEL], level_state, RAND_WORDS, u32b);
+	C_COPY(Rand_state[RAND_STREAM_OBJECT], object_state, RAND_WORDS, u32b);
+	Rand_stream = old_stream;
+
+	PROFILE_COUNT(PROF_LEVELS);
+	PROFILE_STOP(PROF_GENERATE_CAVE);
+}
+
+
+
+
+
+
+
+/*
+ * Names of the reasons for failed attempts, and of the room types
+ */
+static cptr gen_fail_name[GEN_FAIL_MAX] =
+{
+	"couldn't force a forge",
+	"not enough rooms",
+	"couldn't connect the rooms",
+	"couldn't place rubble or player",
+	"failed connectivity",
+	"too many objects",
+	"too many monsters"
+};
+
+static cptr gen_room_name[ROOM_MAX] =
+{
+	NULL,
+	"normal room",
+	"cross room",
+	NULL,
+	NULL,
+	NULL,
+	"interesting room",
+	"lesser vault",
+	"greater vault",
+	NULL,
+	NULL,
+	NULL
+};
+
+
+/*
+ * Compare two times for "qsort()"
+ */
+static int gen_time_comp(const void *a, const void *b)
+{
+	double t1 = *(const double *)a;
+	double t2 = *(const double *)b;
+
+	return ((t1 < t2) ? -1 : (t1 > t2) ? 1 : 0);
+}
+
+
+/*
+ * Print a summary of some generation times (in microseconds) and statistics
+ */
+static void gen_report_line(cptr what, double *times, int num, gen_stats_type *stats)
+{
+	int n = MAX(num, 1);
+
+	qsort(times, num, sizeof(double), gen_time_comp);
+
+	printf("%s levels=%d attempts=%ld ms_p50=%.2f ms_p90=%.2f ms_p99=%.2f ms_max=%.2f monsters=%.1f objects=%.1f\n",
+	       what, num, stats->attempts,
+	       times[num / 2] / 1000.0, times[num * 9 / 10] / 1000.0,
+	       times[num * 99 / 100] / 1000.0, times[num - 1] / 1000.0,
+	       (double)stats->monsters / n, (double)stats->objects / n);
 }
 
 
+/*
+ * Benchmark level generation, making "num" levels at each depth from 1 to
+ * MORGOTH_DEPTH, and print the times they took along with how often the
+ * attempts failed and why, the rooms built and what was on the levels.
+ *
+ * Each level is made for the same character and then thrown away, undoing
+ * any artefacts and uniques it had as if it had failed, so none of them use
+ * anything up for the next.  The game is treated as being under way (so
+ * there is no entry poetry or starting sword), with no forge overdue.
+ *
+ * This is for the "-c" command line option, and quits when it is done.
+ */
+void generate_benchmark(int num)
+{
+	gen_stats_type total, depth_stats;
+	player_type player_body;
+
+	double *times;
+	int depth, i, j;
+
+	C_MAKE(times, num * MORGOTH_DEPTH, double);
+	(void)WIPE(&total, gen_stats_type);
+
+	/* Remember the character, with no forge overdue */
+	COPY(&player_body, p_ptr, player_type);
+	player_body.forge_drought = 0;
+
+	playerturn = 1;
+
+	for (depth = 1; depth <= MORGOTH_DEPTH; depth++)
+	{
+		char buf[20];
+		double *depth_times = &times[(depth - 1) * num];
+
+		(void)WIPE(&depth_stats, gen_stats_type);
+		gen_stats = &depth_stats;
+
+		for (i = 0; i < num; i++)
+		{
+			double start;
+
+			COPY(p_ptr, &player_body, player_type);
+			p_ptr->depth = depth;
+
+			start = profile_clock();
+			generate_cave();
+			depth_times[i] = profile_clock() - start;
+
+			depth_stats.monsters += mon_cnt;
+			depth_stats.objects += o_cnt;
+
+			/* Throw it away */
+			unring_a_bell();
+			wipe_o_list();
+			wipe_mon_list();
+		}
+
+		gen_stats = NULL;
+
+		strnfmt(buf, sizeof(buf), "depth=%d", depth);
+		gen_report_line(buf, depth_times, num, &depth_stats);
+
+		/* Add it up */
+		total.attempts += depth_stats.attempts;
+		total.monsters += depth_stats.monsters;
+		total.objects += depth_stats.objects;
+		total.vaults_failed += depth_stats.vaults_failed;
+		for (j = 0; j < GEN_FAIL_MAX; j++) total.fail[j] += depth_stats.fail[j];
+		for (j = 0; j < ROOM_MAX; j++)
+		{
+			total.rooms[j] += depth_stats.rooms[j];
+			total.rooms_failed[j] += depth_stats.rooms_failed[j];
+		}
+	}
+
+	gen_report_line("all", times, num * MORGOTH_DEPTH, &total);
 
+	/* Why attempts failed */
+	for (j = 0; j < GEN_FAIL_MAX; j++)
+	{
+		printf("%8ld failed: %s\n", total.fail[j], gen_fail_name[j]);
+	}
 
+	/* What was built */
+	for (j = 0; j < ROOM_MAX; j++)
+	{
+		if (!gen_room_name[j]) continue;
+
+		printf("%8ld built: %s (%ld didn't fit)\n", total.rooms[j], gen_room_name[j], total.rooms_failed[j]);
+	}
+
+	printf("%8ld vaults refused for their depth\n", total.vaults_failed);
+
+	fflush(stdout);
+
+	FREE(times);
+
+	COPY(p_ptr, &player_body, player_type);
+
+	quit(NULL);
+}
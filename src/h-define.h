@@ -64,6 +64,21 @@
 #define FALSE	0
 
 
+/*
+ * Storage class for the state of a single game.
+ *
+ * Normally this is nothing at all, and there is one game per process.
+ * Defining "USE_THREADS" gives each thread its own copy instead, so that
+ * several games can be played at once on different threads, each after a
+ * call to "init_game_state()".
+ */
+#ifdef USE_THREADS
+# define GAME_LOCAL	__thread
+#else
+# define GAME_LOCAL
+#endif
+
+
 
 
 /**** Simple "Macros" ****/
@@ -87,6 +87,8 @@
 
 # include <sys/stat.h>
 
+# include <sys/mman.h>
+
 # if defined(SOLARIS)
 #  include <netdb.h>
 # endif
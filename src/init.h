@@ -113,6 +113,7 @@ extern errr parse_h_info(char *buf, header *head);
 extern errr parse_q_info(char *buf, header *head);
 extern errr parse_n_info(char *buf, header *head);
 extern errr parse_flavor_info(char *buf, header *head);
+extern void free_info_flags_index(void);
 
 
 /*
@@ -31,7 +31,7 @@
  * in this file is compiled out, and the game will not run unless valid
  * "binary template files" already exist in "lib/data".  Thus, one can
  * compile Angband with ALLOW_TEMPLATES defined, run once to create the
- * "*.raw" files in "lib/data", and then quit, and recompile without
+ * "info.raw" data cache in "lib/data", and then quit, and recompile without
  * defining ALLOW_TEMPLATES, which will both save 20K and prevent people
  * from changing the ascii template files in potentially dangerous ways.
  *
@@ -1072,15 +1072,44 @@ errr parse_f_info(char *buf, header *head)
 }
 
 
+/*
+ * Finds the entries of "info_flags" by name (built when first needed)
+ */
+static index_table info_flags_index;
+
+
+/*
+ * Free the index of "info_flags"
+ */
+void free_info_flags_index(void)
+{
+	KILL(info_flags_index.slot);
+}
+
+
 /*
  * Grab one flag from a textual string
  */
 static errr grab_one_flag(u32b **flag, cptr errstr, cptr what)
 {
-	uint i;
+	u32b hash = hash_string(what);
+	u32b probe = 0;
+	int i;
+
+	/* Index the flags in order, so that the first match is still found */
+	if (!info_flags_index.slot)
+	{
+		info_flags_index.size = index_table_size(N_ELEMENTS(info_flags));
+		C_MAKE(info_flags_index.slot, info_flags_index.size, u16b);
+
+		for (i = 0; i < (int)N_ELEMENTS(info_flags); i++)
+		{
+			index_table_add(&info_flags_index, hash_string(info_flags[i].name), i);
+		}
+	}
 
 	/* Check flags */
-	for (i = 0; i < N_ELEMENTS(info_flags); i++)
+	while ((i = index_table_find(&info_flags_index, hash, &probe)) >= 0)
 	{
 		flag_name *f_ptr = info_flags+i;
 
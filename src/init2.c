@@ -20,9 +20,9 @@
  * at a time.
  *
  * Several of the arrays for Sil are built from "template" files in
- * the "lib/file" directory, from which quick-load binary "image" files
- * are constructed whenever they are not present in the "lib/data"
- * directory, or if those files become obsolete, if we are allowed.
+ * the "lib/edit" directory, from which a single quick-load binary "data
+ * cache" is constructed whenever it is not present in the "lib/data"
+ * directory, or if it becomes obsolete, if we are allowed.
  *
  * Warning -- the "ascii" file parsers use a minor hack to collect the
  * name and text information in a single pass.  Thus, the game will not
@@ -30,10 +30,10 @@
  * of text, even though technically, up to 64K should be legal.
  *
  * The "init1.c" file is used only to parse the ascii template files,
- * to create the binary image files.  If you include the binary image
- * files instead of the ascii template files, then you can undefine
- * "ALLOW_TEMPLATES", saving about 20K by removing "init1.c".  Note
- * that the binary image files are extremely system dependant.
+ * to create the data cache.  If you include the data cache instead of
+ * the ascii template files, then you can undefine "ALLOW_TEMPLATES",
+ * saving about 20K by removing "init1.c".  Note that the data cache is
+ * extremely system dependant.
  */
 
 
@@ -299,68 +299,442 @@ header q_head;
 header n_head;
 
 
-/*** Initialize from binary image files ***/
+/*** The data cache ***/
 
 
 /*
- * Initialize a "*_info" array, by parsing a binary "image" file
+ * All of the "*_info" arrays, with their names and text, are kept in a
+ * single binary file in "lib/data", which is built from the template files
+ * whenever it is missing or out of date (if we are allowed).
+ *
+ * The file starts with an "info_cache_head", followed by one
+ * "info_cache_table" for each array, and then the arrays themselves.  A
+ * hash of everything after the first header guards against damaged or
+ * half-written files.
+ *
+ * Where we can, the file is mapped into memory rather than read, and the
+ * arrays are used where they lie, so starting a game costs very little and
+ * the many games run at once on one machine all share a single copy of the
+ * pages they never change.  The mapping is private, so the arrays which a
+ * game does change (such as "k_info") get their own copies of those pages.
+ */
+
+
+/*
+ * The name of the data cache, in "lib/data"
+ */
+#define INFO_CACHE_FILE		"info.raw"
+
+/*
+ * The first bytes of a data cache
+ */
+#define INFO_CACHE_MAGIC	"Sil info"
+
+/*
+ * The layout of the data cache (change this whenever the layout changes)
+ */
+#define INFO_CACHE_LAYOUT	1
+
+/*
+ * The most arrays the data cache can hold
+ */
+#define INFO_CACHE_MAX		16
+
+/*
+ * Every array starts at a multiple of this many bytes
+ */
+#define INFO_CACHE_ALIGN	16
+
+
+/*
+ * The header of the data cache
+ */
+typedef struct info_cache_head info_cache_head;
+
+struct info_cache_head
+{
+	char magic[8];		/* INFO_CACHE_MAGIC */
+
+	byte v_major;		/* Version -- major */
+	byte v_minor;		/* Version -- minor */
+	byte v_patch;		/* Version -- patch */
+	byte v_extra;		/* Version -- extra */
+
+	u32b layout;		/* INFO_CACHE_LAYOUT */
+
+	u32b num;			/* Number of arrays */
+	u32b size;			/* Size of the whole file in bytes */
+	u32b check;			/* Hash of everything after this header */
+};
+
+
+/*
+ * One array in the data cache
+ */
+typedef struct info_cache_table info_cache_table;
+
+struct info_cache_table
+{
+	char name[16];		/* The template file it came from (no ".txt") */
+
+	u16b info_num;		/* Number of "info" records */
+	u16b info_len;		/* Size of each "info" record */
+
+	u32b info_size;		/* Size of the "info" array in bytes */
+	u32b name_size;		/* Size of the "name" array in bytes */
+	u32b text_size;		/* Size of the "text" array in bytes */
+
+	u32b info_off;		/* Where the "info" array starts in the file */
+	u32b name_off;		/* Where the "name" array starts in the file */
+	u32b text_off;		/* Where the "text" array starts in the file */
+};
+
+
+/*
+ * The contents of the data cache (mapped or read), if it is usable
+ */
+static char *info_cache;
+static u32b info_cache_size;
+static bool info_cache_mapped;
+
+/*
+ * The data cache file (kept open for "info_cache_reload()")
+ */
+static int info_cache_fd = -1;
+
+/*
+ * The arrays loaded so far, and whether any of them had to be parsed from
+ * their template files
+ */
+static cptr info_cache_name[INFO_CACHE_MAX];
+static header *info_cache_header[INFO_CACHE_MAX];
+static int info_cache_num;
+static bool info_cache_stale;
+
+
+/*
+ * Does this memory belong to the data cache?
+ */
+static bool info_cache_holds(const void *p)
+{
+	const char *c = p;
+
+	return (info_cache && (c >= info_cache) && (c < info_cache + info_cache_size));
+}
+
+
+/*
+ * Forget the data cache
+ */
+static void info_cache_close(void)
+{
+	if (info_cache)
+	{
+#ifdef SET_UID
+		if (info_cache_mapped) (void)munmap(info_cache, info_cache_size);
+		else
+#endif /* SET_UID */
+		FREE(info_cache);
+	}
+
+	info_cache = NULL;
+	info_cache_size = 0;
+	info_cache_mapped = FALSE;
+
+	fd_close(info_cache_fd);
+	info_cache_fd = -1;
+}
+
+
+/*
+ * Open the data cache, if there is a usable one
  */
-static errr init_info_raw(int fd, header *head)
+static void info_cache_open(void)
 {
-	header test;
+	info_cache_head test;
+	char buf[1024];
+
+	/* Build the filename */
+	path_build(buf, sizeof(buf), ANGBAND_DIR_DATA, INFO_CACHE_FILE);
 
+	/* Attempt to open the data cache */
+	info_cache_fd = fd_open(buf, O_RDONLY);
+
+	/* Nothing there */
+	if (info_cache_fd < 0) return;
 
 	/* Read and verify the header */
-	if (fd_read(fd, (char*)(&test), sizeof(header)) ||
-	    (test.v_major != head->v_major) ||
-	    (test.v_minor != head->v_minor) ||
-	    (test.v_patch != head->v_patch) ||
-	    (test.v_extra != head->v_extra) ||
-	    (test.info_num != head->info_num) ||
-	    (test.info_len != head->info_len) ||
-	    (test.head_size != head->head_size) ||
-	    (test.info_size != head->info_size))
+	if (fd_read(info_cache_fd, (char*)(&test), sizeof(test)) ||
+	    memcmp(test.magic, INFO_CACHE_MAGIC, sizeof(test.magic)) ||
+	    (test.v_major != VERSION_MAJOR) ||
+	    (test.v_minor != VERSION_MINOR) ||
+	    (test.v_patch != VERSION_PATCH) ||
+	    (test.v_extra != VERSION_EXTRA) ||
+	    (test.layout != INFO_CACHE_LAYOUT) ||
+	    (test.num > INFO_CACHE_MAX) ||
+	    (test.size < sizeof(test) + test.num * sizeof(info_cache_table)))
 	{
-		/* Error */
-		return (-1);
+		info_cache_close();
+		return;
 	}
 
+	info_cache_size = test.size;
 
-	/* Accept the header */
-	COPY(head, &test, header);
+#ifdef SET_UID
 
+	/* Refuse a file of the wrong length (reading past its end would crash) */
+	{
+		struct stat st;
 
-	/* Allocate the "*_info" array */
-	C_MAKE(head->info_ptr, head->info_size, char);
+		if (fstat(info_cache_fd, &st) || (st.st_size != (off_t)test.size))
+		{
+			info_cache_close();
+			return;
+		}
+	}
 
-	/* Read the "*_info" array */
-	fd_read(fd, head->info_ptr, head->info_size);
+	/* Map the whole file */
+	info_cache = mmap(NULL, info_cache_size, PROT_READ | PROT_WRITE,
+	                  MAP_PRIVATE, info_cache_fd, 0);
 
-	if (head->name_size)
+	/* Remember how to let go of it */
+	if (info_cache == MAP_FAILED) info_cache = NULL;
+	else info_cache_mapped = TRUE;
+
+#endif /* SET_UID */
+
+	/* Read the whole file instead */
+	if (!info_cache)
 	{
-		/* Allocate the "*_name" array */
-		C_MAKE(head->name_ptr, head->name_size, char);
+		C_MAKE(info_cache, info_cache_size, char);
 
-		/* Read the "*_name" array */
-		fd_read(fd, head->name_ptr, head->name_size);
+		if (fd_seek(info_cache_fd, 0) ||
+		    fd_read(info_cache_fd, info_cache, info_cache_size))
+		{
+			info_cache_close();
+			return;
+		}
 	}
 
-	if (head->text_size)
+	/* Check that the file is whole */
+	if (hash_bytes(info_cache + sizeof(test), info_cache_size - sizeof(test)) !=
+	    test.check)
+	{
+		info_cache_close();
+		return;
+	}
+}
+
+
+/*
+ * Find an array in the data cache
+ */
+static info_cache_table *info_cache_find(cptr filename)
+{
+	info_cache_head *c_ptr = (info_cache_head*)info_cache;
+	info_cache_table *table = (info_cache_table*)(info_cache + sizeof(info_cache_head));
+	u32b i;
+
+	/* No data cache */
+	if (!info_cache) return (NULL);
+
+	for (i = 0; i < c_ptr->num; i++)
+	{
+		if (streq(table[i].name, filename)) return (&table[i]);
+	}
+
+	/* Not there */
+	return (NULL);
+}
+
+
+/*
+ * Take a "*_info" array from the data cache
+ */
+static bool info_cache_load(cptr filename, header *head)
+{
+	info_cache_table *t_ptr = info_cache_find(filename);
+
+	/* Not there */
+	if (!t_ptr) return (FALSE);
+
+	/* Verify the array */
+	if ((t_ptr->info_num != head->info_num) ||
+	    (t_ptr->info_len != head->info_len) ||
+	    (t_ptr->info_size != head->info_size) ||
+	    (t_ptr->info_off + t_ptr->info_size > info_cache_size) ||
+	    (t_ptr->name_off + t_ptr->name_size > info_cache_size) ||
+	    (t_ptr->text_off + t_ptr->text_size > info_cache_size))
 	{
-		/* Allocate the "*_text" array */
-		C_MAKE(head->text_ptr, head->text_size, char);
+		return (FALSE);
+	}
+
+#ifdef CHECK_MODIFICATION_TIME
 
-		/* Read the "*_text" array */
-		fd_read(fd, head->text_ptr, head->text_size);
+	/* The template file has changed since */
+	if (check_modification_date(info_cache_fd, format("%s.txt", filename)))
+	{
+		return (FALSE);
 	}
 
+#endif /* CHECK_MODIFICATION_TIME */
+
+	/* Use the arrays where they lie */
+	head->name_size = t_ptr->name_size;
+	head->text_size = t_ptr->text_size;
+	head->info_ptr = info_cache + t_ptr->info_off;
+	head->name_ptr = info_cache + t_ptr->name_off;
+	head->text_ptr = info_cache + t_ptr->text_off;
+
 	/* Success */
-	return (0);
+	return (TRUE);
+}
+
+
+/*
+ * Restore a "*_info" array taken from the data cache to the way it was
+ * loaded, undoing any changes the game has made to it since
+ */
+static bool info_cache_reload(cptr filename, header *head)
+{
+	info_cache_table *t_ptr = info_cache_find(filename);
+
+	/* Paranoia */
+	if (!t_ptr || (head->info_ptr != info_cache + t_ptr->info_off)) return (FALSE);
+
+	/* Read it again from the file */
+	if (fd_seek(info_cache_fd, t_ptr->info_off) ||
+	    fd_read(info_cache_fd, head->info_ptr, t_ptr->info_size))
+	{
+		return (FALSE);
+	}
+
+	/* Success */
+	return (TRUE);
+}
+
+
+/*
+ * Write all the arrays loaded so far to a new data cache
+ *
+ * The new file is written under another name and then moved into place,
+ * so any game which is using the old one can carry on using it.
+ */
+static void info_cache_save(void)
+{
+	info_cache_head *c_ptr;
+	info_cache_table *table;
+
+	char *data;
+	u32b size;
+
+	int i, fd;
+
+	char buf[1024];
+	char tmp[1024];
+
+
+	/* Lay out the file */
+	size = sizeof(info_cache_head) + info_cache_num * sizeof(info_cache_table);
+
+	for (i = 0; i < info_cache_num; i++)
+	{
+		header *head = info_cache_header[i];
+
+		size += head->info_size + head->name_size + head->text_size + 3 * INFO_CACHE_ALIGN;
+	}
+
+	/* Build the file in memory */
+	C_MAKE(data, size, char);
+
+	c_ptr = (info_cache_head*)data;
+	table = (info_cache_table*)(data + sizeof(info_cache_head));
+
+	size = sizeof(info_cache_head) + info_cache_num * sizeof(info_cache_table);
+
+	for (i = 0; i < info_cache_num; i++)
+	{
+		header *head = info_cache_header[i];
+		info_cache_table *t_ptr = &table[i];
+
+		my_strcpy(t_ptr->name, info_cache_name[i], sizeof(t_ptr->name));
+
+		t_ptr->info_num = head->info_num;
+		t_ptr->info_len = head->info_len;
+		t_ptr->info_size = head->info_size;
+		t_ptr->name_size = head->name_size;
+		t_ptr->text_size = head->text_size;
+
+		/* Add the arrays */
+		size = (size + INFO_CACHE_ALIGN - 1) & ~(INFO_CACHE_ALIGN - 1);
+		t_ptr->info_off = size;
+		if (head->info_size) C_COPY(data + size, head->info_ptr, head->info_size, char);
+		size += head->info_size;
+
+		size = (size + INFO_CACHE_ALIGN - 1) & ~(INFO_CACHE_ALIGN - 1);
+		t_ptr->name_off = size;
+		if (head->name_size) C_COPY(data + size, head->name_ptr, head->name_size, char);
+		size += head->name_size;
+
+		size = (size + INFO_CACHE_ALIGN - 1) & ~(INFO_CACHE_ALIGN - 1);
+		t_ptr->text_off = size;
+		if (head->text_size) C_COPY(data + size, head->text_ptr, head->text_size, char);
+		size += head->text_size;
+	}
+
+	/* Fill in the header */
+	memcpy(c_ptr->magic, INFO_CACHE_MAGIC, sizeof(c_ptr->magic));
+	c_ptr->v_major = VERSION_MAJOR;
+	c_ptr->v_minor = VERSION_MINOR;
+	c_ptr->v_patch = VERSION_PATCH;
+	c_ptr->v_extra = VERSION_EXTRA;
+	c_ptr->layout = INFO_CACHE_LAYOUT;
+	c_ptr->num = info_cache_num;
+	c_ptr->size = size;
+	c_ptr->check = hash_bytes(data + sizeof(info_cache_head), size - sizeof(info_cache_head));
+
+
+	/* File type is "DATA" */
+	FILE_TYPE(FILE_TYPE_DATA);
+
+	/* Build the filenames */
+	path_build(buf, sizeof(buf), ANGBAND_DIR_DATA, INFO_CACHE_FILE);
+	path_build(tmp, sizeof(tmp), ANGBAND_DIR_DATA, INFO_CACHE_FILE ".new");
+
+	/* Grab permissions */
+	safe_setuid_grab();
+
+	/* Create a new file (replacing any left over from before) */
+	fd_kill(tmp);
+	fd = fd_make(tmp, 0644);
+
+	/* Write it and move it into place */
+	if (fd < 0)
+	{
+		plog_fmt("Cannot create the '%s' file!", tmp);
+	}
+	else if (fd_write(fd, data, size))
+	{
+		plog_fmt("Cannot write the '%s' file!", tmp);
+
+		fd_close(fd);
+		fd_kill(tmp);
+	}
+	else
+	{
+		fd_close(fd);
+		fd_move(tmp, buf);
+	}
+
+	/* Drop permissions */
+	safe_setuid_drop();
+
+	FREE(data);
 }
 
 
 /*
- * Initialize the header of an *_info.raw file.
+ * Initialize the header of a "*_info" array.
  */
 static void init_header(header *head, int num, int len)
 {
@@ -413,201 +787,133 @@ static void display_parse_error(cptr filename, errr err, cptr buf)
  */
 static errr init_info(cptr filename, header *head)
 {
-	int fd;
-
-	errr err = 1;
-
-	FILE *fp;
-
-	/* General buffer */
-	char buf[1024];
-
+	int i;
 
 #ifdef ALLOW_TEMPLATES
 
-	/*** Load the binary image file ***/
-
-	/* Build the filename */
-	path_build(buf, sizeof(buf), ANGBAND_DIR_DATA, format("%s.raw", filename));
+	errr err;
 
-	/* Attempt to open the "raw" file */
-	fd = fd_open(buf, O_RDONLY);
+	FILE *fp;
 
-	/* Process existing "raw" file */
-	if (fd >= 0)
-	{
-#ifdef CHECK_MODIFICATION_TIME
+	char *name_ptr;
+	char *text_ptr;
 
-		err = check_modification_date(fd, format("%s.txt", filename));
+	/* General buffer */
+	char buf[1024];
 
-#endif /* CHECK_MODIFICATION_TIME */
+#endif /* ALLOW_TEMPLATES */
 
-		/* Attempt to parse the "raw" file */
-		if (!err)
-			err = init_info_raw(fd, head);
 
-		/* Close it */
-		fd_close(fd);
-	}
+	/*** Reload an array from the data cache ***/
 
-	/* Do we have to parse the *.txt file? */
-	if (err)
+	if (info_cache_holds(head->info_ptr))
 	{
-		/*** Make the fake arrays ***/
-
-		/* Allocate the "*_info" array */
-		C_MAKE(head->info_ptr, head->info_size, char);
-
-		/* MegaHack -- make "fake" arrays */
-		if (z_info)
+		if (!info_cache_reload(filename, head))
 		{
-			C_MAKE(head->name_ptr, z_info->fake_name_size, char);
-			C_MAKE(head->text_ptr, z_info->fake_text_size, char);
+			quit(format("Cannot reload '%s' from the data cache.", filename));
 		}
 
+		/* Success */
+		return (0);
+	}
 
-		/*** Load the ascii template file ***/
-
-		/* Build the filename */
-		path_build(buf, sizeof(buf), ANGBAND_DIR_EDIT, format("%s.txt", filename));
-
-		/* Open the file */
-		fp = my_fopen(buf, "r");
-
-		/* Parse it */
-		if (!fp) quit(format("Cannot open '%s.txt' file.", filename));
 
-		/* Parse the file */
-		err = init_info_txt(fp, buf, head, head->parse_info_txt);
+	/*** Remember the array for the data cache ***/
 
-		/* Close it */
-		my_fclose(fp);
+	for (i = 0; i < info_cache_num; i++)
+	{
+		if (info_cache_header[i] == head) break;
+	}
 
-		/* Errors */
-		if (err) display_parse_error(filename, err, buf);
+	if ((i == info_cache_num) && (info_cache_num < INFO_CACHE_MAX))
+	{
+		info_cache_name[info_cache_num] = filename;
+		info_cache_header[info_cache_num] = head;
+		info_cache_num++;
+	}
 
 
-		/*** Dump the binary image file ***/
+	/*** Load the array from the data cache ***/
 
-		/* File type is "DATA" */
-		FILE_TYPE(FILE_TYPE_DATA);
+	if (info_cache_load(filename, head)) return (0);
 
-		/* Build the filename */
-		path_build(buf, sizeof(buf), ANGBAND_DIR_DATA, format("%s.raw", filename));
+#ifdef ALLOW_TEMPLATES
 
+	/*** Make the fake arrays ***/
 
-		/* Attempt to open the file */
-		fd = fd_open(buf, O_RDONLY);
+	/* Allocate the "*_info" array */
+	C_MAKE(head->info_ptr, head->info_size, char);
 
-		/* Failure */
-		if (fd < 0)
-		{
-			int mode = 0644;
+	/* MegaHack -- make "fake" arrays */
+	if (z_info)
+	{
+		C_MAKE(head->name_ptr, z_info->fake_name_size, char);
+		C_MAKE(head->text_ptr, z_info->fake_text_size, char);
+	}
 
-			/* Grab permissions */
-			safe_setuid_grab();
 
-			/* Create a new file */
-			fd = fd_make(buf, mode);
+	/*** Load the ascii template file ***/
 
-			/* Drop permissions */
-			safe_setuid_drop();
+	/* Build the filename */
+	path_build(buf, sizeof(buf), ANGBAND_DIR_EDIT, format("%s.txt", filename));
 
-			/* Failure */
-			if (fd < 0)
-			{
+	/* Open the file */
+	fp = my_fopen(buf, "r");
 
-				/* Complain */
-				plog_fmt("Cannot create the '%s' file!", buf);
+	/* Parse it */
+	if (!fp) quit(format("Cannot open '%s.txt' file.", filename));
 
-				/* Continue */
-				return (0);
-			}
-		}
+	/* Parse the file */
+	err = init_info_txt(fp, buf, head, head->parse_info_txt);
 
-		/* Close it */
-		fd_close(fd);
+	/* Close it */
+	my_fclose(fp);
 
-		/* Grab permissions */
-		safe_setuid_grab();
+	/* Errors */
+	if (err) display_parse_error(filename, err, buf);
 
-		/* Attempt to create the raw file */
-		fd = fd_open(buf, O_WRONLY);
 
-		/* Drop permissions */
-		safe_setuid_drop();
+	/*** Trim the fake arrays ***/
 
-		/* Failure */
-		if (fd < 0)
-		{
-			/* Complain */
-			plog_fmt("Cannot write the '%s' file!", buf);
+	if (z_info)
+	{
+		name_ptr = head->name_ptr;
+		text_ptr = head->text_ptr;
 
-			/* Continue */
-			return (0);
-		}
+		head->name_ptr = NULL;
+		head->text_ptr = NULL;
 
-		/* Dump to the file */
-		if (fd >= 0)
+		if (head->name_size)
 		{
-			/* Dump it */
-			fd_write(fd, (cptr)head, head->head_size);
-
-			/* Dump the "*_info" array */
-			fd_write(fd, head->info_ptr, head->info_size);
-
-			/* Dump the "*_name" array */
-			fd_write(fd, head->name_ptr, head->name_size);
-
-			/* Dump the "*_text" array */
-			fd_write(fd, head->text_ptr, head->text_size);
-
-			/* Close */
-			fd_close(fd);
+			C_MAKE(head->name_ptr, head->name_size, char);
+			C_COPY(head->name_ptr, name_ptr, head->name_size, char);
 		}
 
-
-		/*** Kill the fake arrays ***/
-
-		/* Free the "*_info" array */
-		KILL(head->info_ptr);
-
-		/* MegaHack -- Free the "fake" arrays */
-		if (z_info)
+		if (head->text_size)
 		{
-			KILL(head->name_ptr);
-			KILL(head->text_ptr);
+			C_MAKE(head->text_ptr, head->text_size, char);
+			C_COPY(head->text_ptr, text_ptr, head->text_size, char);
 		}
 
-#endif /* ALLOW_TEMPLATES */
-
-
-		/*** Load the binary image file ***/
-
-		/* Build the filename */
-		path_build(buf, sizeof(buf), ANGBAND_DIR_DATA, format("%s.raw", filename));
+		FREE(name_ptr);
+		FREE(text_ptr);
+	}
 
-		/* Attempt to open the "raw" file */
-		fd = fd_open(buf, O_RDONLY);
+	/* The data cache must be rebuilt */
+	info_cache_stale = TRUE;
 
-		/* Process existing "raw" file */
-		if (fd < 0) quit(format("Cannot load '%s.raw' file.", filename));
+	/* Success */
+	return (0);
 
-		/* Attempt to parse the "raw" file */
-		err = init_info_raw(fd, head);
+#else /* ALLOW_TEMPLATES */
 
-		/* Close it */
-		fd_close(fd);
+	/* Nothing else to try */
+	quit(format("Cannot load '%s' from the data cache.", filename));
 
-		/* Error */
-		if (err) quit(format("Cannot parse '%s.raw' file.", filename));
+	/* Paranoia */
+	return (1);
 
-#ifdef ALLOW_TEMPLATES
-	}
 #endif /* ALLOW_TEMPLATES */
-
-	/* Success */
-	return (0);
 }
 
 
@@ -616,6 +922,9 @@ static errr init_info(cptr filename, header *head)
  */
 static errr free_info(header *head)
 {
+	/* The data cache is freed all at once */
+	if (info_cache_holds(head->info_ptr)) return (0);
+
 	if (head->info_size)
 		FREE(head->info_ptr);
 
@@ -709,6 +1018,9 @@ static errr init_k_info(void)
 	k_name = k_head.name_ptr;
 	k_text = k_head.text_ptr;
 
+	/* Index the kinds by tval and sval */
+	if (!err) index_kinds();
+
 	return (err);
 }
 
@@ -1110,10 +1422,21 @@ extern void re_init_some_things(void)
 	/* Objects */
 	FREE(o_list);
 	C_MAKE(o_list, z_info->o_max, object_type);
+	FREE(o_free);
+	C_MAKE(o_free, z_info->o_max, s16b);
+	o_free_num = 0;
 
 	/* Monsters */
 	FREE(mon_list);
 	C_MAKE(mon_list, MAX_MONSTERS, monster_type);
+	FREE(mon_live);
+	C_MAKE(mon_live, MAX_MONSTERS, s16b);
+	mon_live_num = 0;
+	FREE(mon_free);
+	C_MAKE(mon_free, MAX_MONSTERS, s16b);
+	mon_free_num = 0;
+	FREE(mon_gen);
+	C_MAKE(mon_gen, MAX_MONSTERS, u16b);
 
 
 	/*** Prepare lore array ***/
@@ -1168,112 +1491,17 @@ extern void re_init_some_things(void)
  */
 static errr init_other(void)
 {
-	int i;
-
 	/*** Prepare the various "bizarre" arrays ***/
 
 	/* Initialize the "macro" package */
 	(void)macro_init();
 
-	/* Initialize the "quark" package */
-	(void)quarks_init();
-
-	/* Initialize autoinscriptions */
-	(void)autoinscribe_init();
-
-	/* Initialize the "message" package */
-	(void)messages_init();
-
-	/*** Prepare grid arrays ***/
-
-	/* Array of grids */
-	C_MAKE(view_g, VIEW_MAX, u16b);
-
-	/* Array of grids */
-	C_MAKE(temp_g, TEMP_MAX, u16b);
-
-    /* has_lite patch causes both temp_g and temp_x/y to be used
-    in targetting mode: can't use the same memory any more. */
-    C_MAKE(temp_y, TEMP_MAX, byte);
-    C_MAKE(temp_x, TEMP_MAX, byte);
-
-
-
-	/*** Prepare dungeon arrays ***/
-
-	/* Padded into array */
-	C_MAKE(cave_info, MAX_DUNGEON_HGT, u16b_256);
-
-	/* Feature array */
-	C_MAKE(cave_feat, MAX_DUNGEON_HGT, byte_wid);
-
-	/* Light array */
-	C_MAKE(cave_light, MAX_DUNGEON_HGT, s16b_wid);
-
-	/* Entity arrays */
-	C_MAKE(cave_o_idx, MAX_DUNGEON_HGT, s16b_wid);
-	C_MAKE(cave_m_idx, MAX_DUNGEON_HGT, s16b_wid);
-
-	/* Flow arrays */
-	C_MAKE(cave_when, MAX_DUNGEON_HGT, byte_wid);
-
-	/*** Prepare "vinfo" array ***/
+	/*** Prepare "vinfo" array ***/
 
 	/* Used by "update_view()" */
 	(void)vinfo_init();
 
 
-	/*** Prepare entity arrays ***/
-
-	/* Objects */
-	C_MAKE(o_list, z_info->o_max, object_type);
-
-	/* Monsters */
-	C_MAKE(mon_list, MAX_MONSTERS, monster_type);
-
-
-	/*** Prepare lore array ***/
-
-	/* Lore */
-	C_MAKE(l_list, z_info->r_max, monster_lore);
-
-
-	/*** Prepare the inventory ***/
-
-	/* Allocate it */
-	C_MAKE(inventory, INVEN_TOTAL, object_type);
-
-	/*** Prepare the options ***/
-
-	/* Initialize the options */
-	for (i = 0; i < OPT_MAX; i++)
-	{
-		/* Default value */
-		op_ptr->opt[i] = option_norm[i];
-	}
-
-	/* Initialize the window flags */
-	for (i = 0; i < ANGBAND_TERM_MAX; i++)
-	{
-		/* Assume no flags */
-		op_ptr->window_flag[i] = 0L;
-	}
-
-	// Set some sensible defaults
-	op_ptr->window_flag[WINDOW_INVEN]        |= (PW_INVEN);
-	op_ptr->window_flag[WINDOW_EQUIP]        |= (PW_EQUIP);
-	op_ptr->window_flag[WINDOW_COMBAT_ROLLS] |= (PW_COMBAT_ROLLS);
-	op_ptr->window_flag[WINDOW_MONSTER]      |= (PW_MONSTER);
-	op_ptr->window_flag[WINDOW_PLAYER_0]     |= (PW_PLAYER_0);
-	op_ptr->window_flag[WINDOW_MESSAGE]      |= (PW_MESSAGE);
-	op_ptr->window_flag[WINDOW_MONLIST]      |= (PW_MONLIST);
-	
-	/*** Pre-allocate space for the "format()" buffer ***/
-
-	/* Hack -- Just call the "format()" function */
-	(void)format("%s", MAINTAINER);
-
-
 	/* Success */
 	return (0);
 }
@@ -1554,6 +1782,214 @@ static errr init_alloc(void)
 }
 
 
+/*
+ * Initialize the state of a single game
+ *
+ * This is everything that changes during play, as opposed to the tables
+ * parsed from "lib/edit", which are loaded once by "init_angband()".
+ *
+ * When "USE_THREADS" is defined, every thread that is to play a game must
+ * call this (after "init_angband()" has finished on the main thread), and
+ * it then gets its own copies of the object, artefact, special item and
+ * monster records, since these keep some per-game details such as which
+ * flavors are known and how many of each unique are alive.  The names and
+ * descriptions, and all the other tables, are shared.
+ */
+void init_game_state(void)
+{
+	int i;
+
+#ifdef USE_THREADS
+
+	/* Copy the records that hold per-game details */
+	if (!k_info)
+	{
+		C_MAKE(k_info, z_info->k_max, object_kind);
+		C_COPY(k_info, k_head.info_ptr, z_info->k_max, object_kind);
+
+		C_MAKE(a_info, z_info->art_max, artefact_type);
+		C_COPY(a_info, a_head.info_ptr, z_info->art_max, artefact_type);
+
+		C_MAKE(e_info, z_info->e_max, ego_item_type);
+		C_COPY(e_info, e_head.info_ptr, z_info->e_max, ego_item_type);
+
+		C_MAKE(r_info, z_info->r_max, monster_race);
+		C_COPY(r_info, r_head.info_ptr, z_info->r_max, monster_race);
+	}
+
+#endif /* USE_THREADS */
+
+	/* Initialize the "quark" package */
+	(void)quarks_init();
+
+	/* Initialize autoinscriptions */
+	(void)autoinscribe_init();
+
+	/* Initialize the "message" package */
+	(void)messages_init();
+
+	/*** Prepare grid arrays ***/
+
+	/* Array of grids */
+	C_MAKE(view_g, VIEW_MAX, u16b);
+
+	/* Array of grids */
+	C_MAKE(temp_g, TEMP_MAX, u16b);
+
+    /* has_lite patch causes both temp_g and temp_x/y to be used
+    in targetting mode: can't use the same memory any more. */
+    C_MAKE(temp_y, TEMP_MAX, byte);
+    C_MAKE(temp_x, TEMP_MAX, byte);
+
+
+
+	/*** Prepare dungeon arrays ***/
+
+	/* Padded into array */
+	C_MAKE(cave_info, MAX_DUNGEON_HGT, u16b_256);
+
+	/* Feature array */
+	C_MAKE(cave_feat, MAX_DUNGEON_HGT, byte_wid);
+
+	/* Light array */
+	C_MAKE(cave_light, MAX_DUNGEON_HGT, s16b_wid);
+
+	/* Entity arrays */
+	C_MAKE(cave_o_idx, MAX_DUNGEON_HGT, s16b_wid);
+	C_MAKE(cave_m_idx, MAX_DUNGEON_HGT, s16b_wid);
+
+	/* Flow arrays */
+	C_MAKE(cave_when, MAX_DUNGEON_HGT, byte_wid);
+
+
+	/*** Prepare entity arrays ***/
+
+	/* Objects */
+	C_MAKE(o_list, z_info->o_max, object_type);
+	C_MAKE(o_free, z_info->o_max, s16b);
+
+	/* Monsters */
+	C_MAKE(mon_list, MAX_MONSTERS, monster_type);
+	C_MAKE(mon_live, MAX_MONSTERS, s16b);
+	C_MAKE(mon_free, MAX_MONSTERS, s16b);
+	C_MAKE(mon_gen, MAX_MONSTERS, u16b);
+
+
+	/*** Prepare lore array ***/
+
+	/* Lore */
+	C_MAKE(l_list, z_info->r_max, monster_lore);
+
+
+	/*** Prepare the inventory ***/
+
+	/* Allocate it */
+	C_MAKE(inventory, INVEN_TOTAL, object_type);
+
+	/*** Prepare the options ***/
+
+	/* Initialize the options */
+	for (i = 0; i < OPT_MAX; i++)
+	{
+		/* Default value */
+		op_ptr->opt[i] = option_norm[i];
+	}
+
+	/* Initialize the window flags */
+	for (i = 0; i < ANGBAND_TERM_MAX; i++)
+	{
+		/* Assume no flags */
+		op_ptr->window_flag[i] = 0L;
+	}
+
+	// Set some sensible defaults
+	op_ptr->window_flag[WINDOW_INVEN]        |= (PW_INVEN);
+	op_ptr->window_flag[WINDOW_EQUIP]        |= (PW_EQUIP);
+	op_ptr->window_flag[WINDOW_COMBAT_ROLLS] |= (PW_COMBAT_ROLLS);
+	op_ptr->window_flag[WINDOW_MONSTER]      |= (PW_MONSTER);
+	op_ptr->window_flag[WINDOW_PLAYER_0]     |= (PW_PLAYER_0);
+	op_ptr->window_flag[WINDOW_MESSAGE]      |= (PW_MESSAGE);
+	op_ptr->window_flag[WINDOW_MONLIST]      |= (PW_MONLIST);
+
+	/*** Pre-allocate space for the "format()" buffer ***/
+
+	/* Hack -- Just call the "format()" function */
+	(void)format("%s", MAINTAINER);
+
+	/*** Prepare the allocation tables ***/
+
+	if (init_alloc()) quit("Cannot initialize alloc stuff");
+}
+
+
+/*
+ * Free the state of a single game (see "init_game_state()")
+ */
+void cleanup_game_state(void)
+{
+	/* Free the allocation tables */
+	FREE(alloc_ego_table);
+	FREE(alloc_race_table);
+	FREE(alloc_kind_table);
+
+	/* Free the player inventory */
+	FREE(inventory);
+
+	/*Clean the Autoinscribe*/
+	autoinscribe_clean();
+
+	/* Free the lore, monster, and object lists */
+	FREE(l_list);
+	FREE(mon_list);
+	FREE(mon_live);
+	FREE(mon_free);
+	FREE(mon_gen);
+	FREE(o_list);
+	FREE(o_free);
+
+	/* Flow arrays */
+	FREE(cave_when);
+	free_flows();
+
+	/* Free the cave */
+	FREE(cave_o_idx);
+	FREE(cave_m_idx);
+	FREE(cave_feat);
+	FREE(cave_info);
+	FREE(cave_light);
+
+	/* Free the "update_view()" array */
+	FREE(view_g);
+
+	/* Free the temp arrays */
+	FREE(temp_g);
+	FREE(temp_y);
+	FREE(temp_x);
+
+	/* Free the messages */
+	messages_free();
+
+	/* Free the "quarks" */
+	quarks_free();
+
+	/* Free the format() buffer */
+	vformat_kill();
+
+#ifdef USE_THREADS
+
+	/* Free this thread's copies of the records */
+	if (k_info != k_head.info_ptr)
+	{
+		FREE(k_info);
+		FREE(a_info);
+		FREE(e_info);
+		FREE(r_info);
+	}
+
+#endif /* USE_THREADS */
+}
+
+
 /*
  * Hack -- take notes on line 23
  */
@@ -1700,6 +2136,9 @@ void init_angband(void)
 
 	/*** Initialize some arrays ***/
 
+	/* Open the data cache */
+	info_cache_open();
+
 	/* Initialize size info */
 	note("[Initializing array sizes...]");
 	if (init_z_info()) quit("Cannot initialize sizes");
@@ -1748,13 +2187,21 @@ void init_angband(void)
 	note("[Initializing arrays... (flavors)]");
 	if (init_flavor_info()) quit("Cannot initialize flavors");
 
+	/* Initialize the random name table */
+	note("[Initializing arrays... (names)]");
+	if (init_n_info())
+	  quit("Cannot initialize random name generator stuff");
+
+	/* Rebuild the data cache if it was missing or out of date */
+	if (info_cache_stale) info_cache_save();
+
 	/* Initialize some other arrays */
 	note("[Initializing arrays... (other)]");
 	if (init_other()) quit("Cannot initialize other stuff");
 
-	/* Initialize some other arrays */
-	note("[Initializing arrays... (alloc)]");
-	if (init_alloc()) quit("Cannot initialize alloc stuff");
+	/* Initialize the game itself */
+	note("[Initializing arrays... (game)]");
+	init_game_state();
 
 	/*** Load default user pref files ***/
 
@@ -1768,10 +2215,6 @@ void init_angband(void)
 	/* Initialize feature info */
 	note("[Initializing Random Artefact Tables...]");
 
-	/* Initialize the random name table */
-	if (init_n_info())
-	  quit("Cannot initialize random name generator stuff");
-
 	/*Build the randart probability tables based on the standard Artefact Set*/
 	build_randart_tables();
 
@@ -1876,43 +2319,8 @@ void cleanup_angband(void)
 	/* Free the macro triggers */
 	macro_trigger_free();
 
-	/* Free the allocation tables */
-	FREE(alloc_ego_table);
-	FREE(alloc_race_table);
-	FREE(alloc_kind_table);
-
-	/* Free the player inventory */
-	FREE(inventory);
-
-	/*Clean the Autoinscribe*/
-	autoinscribe_clean();
-
-	/* Free the lore, monster, and object lists */
-	FREE(l_list);
-	FREE(mon_list);
-	FREE(o_list);
-
-	/* Flow arrays */
-	FREE(cave_when);
-
-	/* Free the cave */
-	FREE(cave_o_idx);
-	FREE(cave_m_idx);
-	FREE(cave_feat);
-	FREE(cave_info);
-	FREE(cave_light);
-
-	/* Free the "update_view()" array */
-	FREE(view_g);
-
-	/* Free the temp array */
-	FREE(temp_g);
-
-	/* Free the messages */
-	messages_free();
-
-	/* Free the "quarks" */
-	quarks_free();
+	/* Free the game itself */
+	cleanup_game_state();
 
 	/*free the randart arrays*/
 	free_randart_tables();
@@ -1929,12 +2337,16 @@ void cleanup_angband(void)
 	free_info(&e_head);
 	free_info(&a_head);
 	free_info(&k_head);
+	KILL(k_index.slot);
+#ifdef ALLOW_TEMPLATES
+	free_info_flags_index();
+#endif /* ALLOW_TEMPLATES */
 	free_info(&f_head);
 	free_info(&z_head);
 	free_info(&n_head);
 
-	/* Free the format() buffer */
-	vformat_kill();
+	/* Free the data cache */
+	info_cache_close();
 
 	/* Free the directories */
 	string_free(ANGBAND_DIR);
@@ -39,27 +39,33 @@
  */
 
 /*
- * Local "savefile" pointer
+ * The whole savefile, read into memory at once
  */
-static FILE	*fff;
+static GAME_LOCAL byte	*sf_buf;
+
+/*
+ * The size of the savefile, and how much of it has been read
+ */
+static GAME_LOCAL u32b	sf_len;
+static GAME_LOCAL u32b	sf_pos;
 
 /*
  * Hack -- old "encryption" byte
  */
-static byte	xor_byte;
+static GAME_LOCAL byte	xor_byte;
 
 /*
  * Hack -- simple "checksum" on the actual values
  */
-static u32b	v_check = 0L;
+static GAME_LOCAL u32b	v_check = 0L;
 
 /*
  * Hack -- simple "checksum" on the encoded bytes
  */
-static u32b	x_check = 0L;
+static GAME_LOCAL u32b	x_check = 0L;
 
-static u16b new_artefacts;
-static u16b art_norm_count;
+static GAME_LOCAL u16b new_artefacts;
+static GAME_LOCAL u16b art_norm_count;
 
 
 /*
@@ -167,8 +173,8 @@ static byte sf_get(void)
 {
 	byte c, v;
 
-	/* Get a character, decode the value */
-	c = getc(fff) & 0xFF;
+	/* Get a character (as "getc()" would, past the end), decode the value */
+	c = (sf_pos < sf_len) ? sf_buf[sf_pos++] : 0xFF;
 	v = c ^ xor_byte;
 	xor_byte = c;
 
@@ -567,6 +573,7 @@ static void rd_lore(int r_idx)
 
 	/* Read the "Racial" monster limit per level */
 	rd_byte(&r_ptr->max_num);
+	alloc_race_version++;
 
 	// 8 spare bytes
 	strip_bytes(8);
@@ -585,17 +592,22 @@ static void rd_lore(int r_idx)
 static void rd_randomizer(void)
 {
 	int i;
+	u32b tmp32u;
 
 	// 8 spare bytes
 	strip_bytes(8);
 	
-	/* Place */
-	rd_u16b(&Rand_place);
+	/* Current stream */
+	rd_u16b(&Rand_stream);
+
+	/* Paranoia */
+	if (Rand_stream >= RAND_STREAMS) Rand_stream = RAND_STREAM_MISC;
 
-	/* State */
+	/* State of each stream (padded out to the old size) */
 	for (i = 0; i < RAND_DEG; i++)
 	{
-		rd_u32b(&Rand_state[i]);
+		rd_u32b(&tmp32u);
+		if (i < RAND_STREAMS * RAND_WORDS) Rand_state[i / RAND_WORDS][i % RAND_WORDS] = tmp32u;
 	}
 
 	/* Accept */
@@ -720,7 +732,7 @@ static void rd_options(void)
 
 
 
-static u32b randart_version;
+static GAME_LOCAL u32b randart_version;
 
 
 /*
@@ -1324,6 +1336,10 @@ static errr rd_dungeon(void)
 		return (1);
 	}
 
+	/* Nothing has been seen yet */
+	wipe_view_history();
+	wipe_los_cache();
+
 
 	/*** Run length decoding ***/
 
@@ -1541,6 +1557,9 @@ static errr rd_dungeon(void)
 		m_ptr->hold_o_idx = i;
 	}
 
+	// start without any flows from a previous level
+	wipe_flows();
+
 	// dump the wandering monster information
 	for (i = FLOW_WANDERING_HEAD; i <= FLOW_WANDERING_TAIL; i++)
 	{
@@ -1755,7 +1774,11 @@ static errr rd_savefile_new_aux(void)
  */
 static errr rd_savefile(void)
 {
-	errr err;
+	errr err = 0;
+
+	long size;
+
+	FILE *fff;
 
 	/* Grab permissions */
 	safe_setuid_grab();
@@ -1769,15 +1792,32 @@ static errr rd_savefile(void)
 	/* Paranoia */
 	if (!fff) return (-1);
 
-	/* Call the sub-function */
-	err = rd_savefile_new_aux();
+	/* Find the size of the savefile */
+	if (fseek(fff, 0L, SEEK_END) || ((size = ftell(fff)) < 0)) err = -1;
+
+	/* Read the whole savefile at once */
+	if (!err)
+	{
+		sf_len = (u32b)size;
+		sf_pos = 0;
+
+		C_MAKE(sf_buf, sf_len + 1, byte);
 
-	/* Check for errors */
-	if (ferror(fff)) err = -1;
+		rewind(fff);
+
+		if (fread(sf_buf, 1, sf_len, fff) != sf_len) err = -1;
+	}
 
 	/* Close the file */
 	my_fclose(fff);
 
+	/* Call the sub-function */
+	if (!err) err = rd_savefile_new_aux();
+
+	/* Free the savefile */
+	KILL(sf_buf);
+	sf_len = sf_pos = 0;
+
 	/* Result */
 	return (err);
 }
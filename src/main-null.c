@@ -0,0 +1,159 @@
+/* File: main-null.c */
+
+/*
+ * Copyright (c) 1997 Ben Harrison, and others
+ *
+ * This software may be copied and distributed for educational, research,
+ * and not for profit purposes provided that this copyright and statement
+ * are included in all such copies.
+ */
+
+
+/*
+ * This file provides a "null" visual module, which displays nothing at all
+ * and never has any keypresses to offer.
+ *
+ * It is used for batch games (see the "-b" option in main.c), where the
+ * automaton supplies every keypress and nobody is watching, so that no time
+ * is spent drawing or waiting.  It needs no libraries, so it is always
+ * compiled in, but it is only ever used when it is asked for by name.
+ *
+ * The game still draws into the "virtual" screen held by "z-term.c", but
+ * none of it is ever sent anywhere.
+ */
+
+
+#include "angband.h"
+
+#include "main.h"
+
+
+/*
+ * The one and only (invisible) term (one per thread, see "GAME_LOCAL")
+ */
+static GAME_LOCAL term term_null;
+
+
+/*
+ * Do a "special thing" -- almost everything is ignored
+ */
+static errr Term_xtra_null(int n, int v)
+{
+	switch (n)
+	{
+		case TERM_XTRA_EVENT:
+		{
+			/*
+			 * There will never be a keypress, so waiting for one would
+			 * hang forever.  This only happens if the game asks for a key
+			 * when the automaton isn't supplying them.
+			 */
+			if (v) quit("The null module was asked to wait for a keypress.");
+
+			return (0);
+		}
+
+		case TERM_XTRA_FLUSH:
+		case TERM_XTRA_CLEAR:
+		case TERM_XTRA_SHAPE:
+		case TERM_XTRA_FROSH:
+		case TERM_XTRA_FRESH:
+		case TERM_XTRA_NOISE:
+		case TERM_XTRA_SOUND:
+		case TERM_XTRA_BORED:
+		case TERM_XTRA_REACT:
+		case TERM_XTRA_ALIVE:
+		case TERM_XTRA_LEVEL:
+		case TERM_XTRA_DELAY:
+		{
+			return (0);
+		}
+	}
+
+	/* Unknown or Unhandled action */
+	return (1);
+}
+
+
+/*
+ * Move the cursor (nowhere)
+ */
+static errr Term_curs_null(int x, int y)
+{
+	/* Unused parameters */
+	(void)x;
+	(void)y;
+
+	return (0);
+}
+
+
+/*
+ * Erase some characters (that were never shown)
+ */
+static errr Term_wipe_null(int x, int y, int n)
+{
+	/* Unused parameters */
+	(void)x;
+	(void)y;
+	(void)n;
+
+	return (0);
+}
+
+
+/*
+ * Draw some text (that will never be shown)
+ */
+static errr Term_text_null(int x, int y, int n, byte a, const char *cp)
+{
+	/* Unused parameters */
+	(void)x;
+	(void)y;
+	(void)n;
+	(void)a;
+	(void)cp;
+
+	return (0);
+}
+
+
+/*
+ * Help message.
+ */
+const char help_null[] = "Null module, displays nothing (used by batch games)";
+
+
+/*
+ * Initialization function
+ */
+errr init_null(int argc, char **argv)
+{
+	term *t = &term_null;
+
+	/* Unused parameters */
+	(void)argc;
+	(void)argv;
+
+	/* Initialize the term (the smallest size the game accepts) */
+	term_init(t, 80, 24, 256);
+
+	/* Nothing is ever bored or frosh */
+	t->never_bored = TRUE;
+	t->never_frosh = TRUE;
+
+	/* Prepare the template hooks */
+	t->xtra_hook = Term_xtra_null;
+	t->curs_hook = Term_curs_null;
+	t->wipe_hook = Term_wipe_null;
+	t->text_hook = Term_text_null;
+
+	/* Activate it */
+	Term_activate(t);
+
+	/* Global pointer */
+	angband_term[0] = t;
+
+	/* Success */
+	return (0);
+}
@@ -3191,7 +3191,7 @@ static void check_for_save_file(LPSTR cmd_line)
  * be switched off when recording.
  */
 
-extern char (*inkey_hack)(int flush_first);
+extern GAME_LOCAL char (*inkey_hack)(int flush_first);
 
 static char screensaver_inkey_hack_buffer[1024];
 
@@ -86,6 +86,9 @@ static const struct module modules[] =
 #ifdef USE_VCS
 	{ "vcs", help_vcs, init_vcs },
 #endif /* USE_VCS */
+
+	/* Only used when asked for by name (see below) */
+	{ "null", help_null, init_null },
 };
 
 
@@ -101,6 +104,14 @@ static void quit_hook(cptr s)
 	/* Unused parameter */
 	(void)s;
 
+	/* Finish any keypress log */
+	keylog_close();
+
+#ifdef ALLOW_PROFILE
+	/* Say where the time went */
+	profile_report(stderr);
+#endif
+
 	/* Scan windows */
 	for (j = ANGBAND_TERM_MAX - 1; j >= 0; j--)
 	{
@@ -353,6 +364,311 @@ static void change_path(cptr info)
 }
 
 
+#ifdef SET_UID
+
+#include <sys/wait.h>
+
+/*
+ * The most worker processes a batch farm can have
+ */
+#define FARM_MAX_WORKERS	256
+
+/*
+ * The most causes of death a batch farm report lists separately
+ */
+#define FARM_MAX_CAUSES		100
+
+
+/*
+ * The totals for a batch farm report
+ */
+static int farm_games;
+static int farm_died, farm_escaped, farm_timeout, farm_stuck, farm_crashed;
+static long farm_depth, farm_max_depth, farm_deepest;
+static long farm_turns, farm_kills;
+
+static char farm_cause[FARM_MAX_CAUSES][80];
+static int farm_cause_num[FARM_MAX_CAUSES];
+static int farm_causes;
+
+
+/*
+ * Extracts a number from a batch game record (see automaton_batch_end())
+ */
+static long farm_value(cptr line, cptr key)
+{
+	char buf[32];
+	cptr s;
+
+	strnfmt(buf, sizeof(buf), " %s=", key);
+
+	s = strstr(line, buf);
+	if (!s) return (0);
+
+	return (atol(s + strlen(buf)));
+}
+
+
+/*
+ * Adds a batch game record to the totals
+ */
+static void farm_count(cptr line)
+{
+	cptr s;
+	int i;
+
+	farm_games++;
+
+	if (strstr(line, " result=died "))          farm_died++;
+	else if (strstr(line, " result=escaped "))  farm_escaped++;
+	else if (strstr(line, " result=timeout "))  farm_timeout++;
+	else if (strstr(line, " result=stuck "))    farm_stuck++;
+	else                                        farm_crashed++;
+
+	farm_depth += farm_value(line, "depth");
+	farm_max_depth += farm_value(line, "max_depth");
+	farm_deepest = MAX(farm_deepest, farm_value(line, "max_depth"));
+	farm_turns += farm_value(line, "turns");
+	farm_kills += farm_value(line, "kills");
+
+	/* Only deaths have causes */
+	if (!strstr(line, " result=died ")) return;
+
+	/* The cause is the rest of the line */
+	s = strstr(line, " cause=");
+	if (!s) return;
+	s += strlen(" cause=");
+
+	for (i = 0; i < farm_causes; i++)
+	{
+		if (streq(farm_cause[i], s)) break;
+	}
+
+	/* A new cause (lumping the rarest together if there are too many) */
+	if (i == farm_causes)
+	{
+		if (farm_causes == FARM_MAX_CAUSES) i = FARM_MAX_CAUSES - 1;
+		else farm_causes++;
+
+		if (!farm_cause_num[i]) my_strcpy(farm_cause[i], s, sizeof(farm_cause[i]));
+		else                    my_strcpy(farm_cause[i], "(other)", sizeof(farm_cause[i]));
+	}
+
+	farm_cause_num[i]++;
+}
+
+
+/*
+ * Prints the report of a batch farm
+ */
+static void farm_report(void)
+{
+	int i, j, n = MAX(farm_games, 1);
+
+	printf("games=%d died=%d escaped=%d timeout=%d stuck=%d crashed=%d\n",
+	       farm_games, farm_died, farm_escaped, farm_timeout, farm_stuck, farm_crashed);
+	printf("mean depth=%.2f max_depth=%.2f deepest=%ld turns=%.0f kills=%.2f\n",
+	       (double)farm_depth / n, (double)farm_max_depth / n, farm_deepest,
+	       (double)farm_turns / n, (double)farm_kills / n);
+
+	/* Causes of death, most common first (alphabetically among equals) */
+	for (i = 0; i < farm_causes; i++)
+	{
+		int best = i;
+
+		for (j = i + 1; j < farm_causes; j++)
+		{
+			if ((farm_cause_num[j] > farm_cause_num[best]) ||
+			    ((farm_cause_num[j] == farm_cause_num[best]) &&
+			     (strcmp(farm_cause[j], farm_cause[best]) < 0)))
+			{
+				best = j;
+			}
+		}
+
+		printf("%6d %s\n", farm_cause_num[best], farm_cause[best]);
+
+		/* Swap it into place */
+		if (best != i)
+		{
+			char tmp[80];
+			int num = farm_cause_num[i];
+
+			my_strcpy(tmp, farm_cause[i], sizeof(tmp));
+			my_strcpy(farm_cause[i], farm_cause[best], sizeof(farm_cause[i]));
+			my_strcpy(farm_cause[best], tmp, sizeof(farm_cause[best]));
+			farm_cause_num[i] = farm_cause_num[best];
+			farm_cause_num[best] = num;
+		}
+	}
+
+	fflush(stdout);
+}
+
+
+/*
+ * Plays the batch games for seeds 'first' to 'last' with 'workers' worker
+ * processes, streaming each game's record to the standard output as it
+ * comes in, and finishing with a report of the totals.
+ *
+ * Each worker is handed an equal share of the seeds and plays its games one
+ * at a time, each in a process of its own (the game state is global and a
+ * batch game only ends by quitting).  The records come back down a pipe from
+ * each worker.  All of the processes are forked once the game has been
+ * initialised, so none of them need to read the data files again.
+ *
+ * Only ever returns in a process which should play the game for the seed
+ * in 'arg_batch_seed'.
+ */
+static void batch_farm(u32b first, u32b last, int workers)
+{
+	int fds[FARM_MAX_WORKERS];
+	char buf[FARM_MAX_WORKERS][1024];
+	int len[FARM_MAX_WORKERS];
+
+	u32b games = last - first + 1;
+	int i, open_fds = 0;
+
+	if (workers > FARM_MAX_WORKERS) workers = FARM_MAX_WORKERS;
+	if ((u32b)workers > games) workers = (int)games;
+
+	for (i = 0; i < workers; i++)
+	{
+		int p[2];
+		pid_t pid;
+
+		if (pipe(p) < 0) quit("Could not create a pipe for a batch worker.");
+
+		pid = fork();
+		if (pid < 0) quit("Could not fork a batch worker.");
+
+		/* A worker */
+		if (pid == 0)
+		{
+			u32b seed;
+			u32b from = first + (u32b)(((double)games * i) / workers);
+			u32b to = first + (u32b)(((double)games * (i + 1)) / workers);
+			int j;
+
+			/* Only keep our own pipe */
+			for (j = 0; j < open_fds; j++) close(fds[j]);
+			close(p[0]);
+
+			for (seed = from; seed != to; seed++)
+			{
+				int status;
+				pid_t game = fork();
+
+				if (game < 0) quit("Could not fork a batch game.");
+
+				/* A game, which sends its record down the pipe */
+				if (game == 0)
+				{
+					if (dup2(p[1], STDOUT_FILENO) < 0) quit("Could not redirect a batch game.");
+					close(p[1]);
+
+					arg_batch_seed = seed;
+					return;
+				}
+
+				(void)waitpid(game, &status, 0);
+
+				/* Games that didn't finish properly still need a record */
+				if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+				{
+					char line[80];
+
+					strnfmt(line, sizeof(line), "seed=%lu result=crashed cause=-\n", (unsigned long)seed);
+					(void)write(p[1], line, strlen(line));
+				}
+			}
+
+			/* Done, without disturbing the display module */
+			_exit(0);
+		}
+
+		/* The farm keeps the reading end */
+		close(p[1]);
+		fds[open_fds] = p[0];
+		len[open_fds] = 0;
+		open_fds++;
+	}
+
+	/* Collect the records until all the workers are done */
+	while (open_fds > 0)
+	{
+		fd_set set;
+		int max_fd = -1;
+
+		FD_ZERO(&set);
+		for (i = 0; i < open_fds; i++)
+		{
+			FD_SET(fds[i], &set);
+			if (fds[i] > max_fd) max_fd = fds[i];
+		}
+
+		if (select(max_fd + 1, &set, NULL, NULL, NULL) < 0)
+		{
+			if (errno == EINTR) continue;
+			quit("Could not wait for the batch workers.");
+		}
+
+		for (i = 0; i < open_fds; i++)
+		{
+			int n;
+			char *nl;
+
+			if (!FD_ISSET(fds[i], &set)) continue;
+
+			n = read(fds[i], buf[i] + len[i], sizeof(buf[i]) - 1 - len[i]);
+
+			/* The worker is done */
+			if (n <= 0)
+			{
+				close(fds[i]);
+
+				open_fds--;
+				fds[i] = fds[open_fds];
+				len[i] = len[open_fds];
+				memcpy(buf[i], buf[open_fds], len[open_fds]);
+
+				i--;
+				continue;
+			}
+
+			len[i] += n;
+			buf[i][len[i]] = '\0';
+
+			/* Pass on and count each complete record */
+			while ((nl = strchr(buf[i], '\n')) != NULL)
+			{
+				*nl = '\0';
+
+				printf("%s\n", buf[i]);
+				farm_count(buf[i]);
+
+				len[i] -= (nl + 1 - buf[i]);
+				memmove(buf[i], nl + 1, len[i] + 1);
+			}
+
+			/* Paranoia -- overlong records */
+			if (len[i] == (int)sizeof(buf[i]) - 1) len[i] = 0;
+		}
+
+		fflush(stdout);
+	}
+
+	/* Reap the workers */
+	while (wait(NULL) > 0) ;
+
+	farm_report();
+
+	quit(NULL);
+}
+
+#endif /* SET_UID */
+
+
 /*
  * Simple "main" function for multiple platforms.
  *
@@ -374,6 +690,10 @@ int main(int argc, char *argv[])
 
 	bool args = TRUE;
 
+	u32b last_seed = 0;
+
+	int workers = 0;
+
 
 	/* Save the "program name" XXX XXX XXX */
 	argv0 = argv[0];
@@ -560,6 +880,75 @@ int main(int argc, char *argv[])
 				continue;
 			}
 
+			case 'b':
+			case 'B':
+			{
+				char *end;
+
+				if (!*arg) goto usage;
+
+				/* Play a new game with the automaton from this seed */
+				arg_batch = TRUE;
+				arg_batch_seed = (u32b)strtoul(arg, &end, 10);
+
+				/* Or a range of games */
+				last_seed = arg_batch_seed;
+				if (*end == '-') last_seed = (u32b)strtoul(end + 1, NULL, 10);
+				if (last_seed < arg_batch_seed) goto usage;
+
+				new_game = TRUE;
+				game_in_progress = TRUE;
+				continue;
+			}
+
+			case 't':
+			case 'T':
+			{
+				if (!*arg) goto usage;
+				arg_batch_turns = atol(arg);
+				continue;
+			}
+
+			case 'c':
+			case 'C':
+			{
+				if (!*arg) goto usage;
+
+				/* Make levels for a new batch character */
+				arg_gen_levels = atoi(arg);
+				if (arg_gen_levels < 1) goto usage;
+
+				arg_batch = TRUE;
+				new_game = TRUE;
+				game_in_progress = TRUE;
+				continue;
+			}
+
+			case 'j':
+			case 'J':
+			{
+				if (!*arg) goto usage;
+				workers = atoi(arg);
+				if (workers < 1) goto usage;
+				continue;
+			}
+
+			case 'l':
+			case 'L':
+			{
+				if (!*arg) goto usage;
+				arg_keylog = arg;
+				continue;
+			}
+
+			case 'p':
+			case 'P':
+			{
+				if (!*arg) goto usage;
+				arg_replay = arg;
+				continue;
+			}
+
 			case 'd':
 			case 'D':
 			{
@@ -591,6 +980,13 @@ int main(int argc, char *argv[])
 				puts("  -s<num>  Show <num> high scores (default: 10)");
 				puts("  -u<who>  Use your <who> savefile");
 				puts("  -d<def>  Define a 'lib' dir sub-path");
+				puts("  -b<seed> Play a batch game with the automaton (no display)");
+				puts("  -b<a>-<b> Play batch games for seeds <a> to <b> and report");
+				puts("  -t<num>  Stop a batch game after <num> game turns");
+				puts("  -j<num>  Play batch games in <num> processes at once");
+				puts("  -c<num>  Benchmark making <num> levels at each depth (no display)");
+				puts("  -l<file> Record every keypress of the game to <file>");
+				puts("  -p<file> Replay the keypresses in <file> (no display)");
 				puts("  -m<sys>  use Module <sys>, where <sys> can be:");
 
 				/* Print the name and help for each available module */
@@ -619,12 +1015,40 @@ int main(int argc, char *argv[])
 	////process_player_name(TRUE);
 
 
+	/* Replay a keypress log, starting the game the same way it was started */
+	if (arg_replay)
+	{
+		bool loaded;
+
+		if (keylog_replay(arg_replay, &arg_batch, &arg_batch_seed, &loaded))
+		{
+			quit_fmt("Cannot replay the keypress log '%s'.", arg_replay);
+		}
+
+		/* Use the copy of the savefile the game came from */
+		if (loaded) strnfmt(savefile, sizeof(savefile), "%s.sav", arg_replay);
+
+		/* Don't record a replay or split it into several games */
+		arg_keylog = NULL;
+		last_seed = arg_batch_seed;
+		workers = 0;
+
+		new_game = !loaded;
+		game_in_progress = TRUE;
+	}
+
+	/* Batch games and replays are never displayed */
+	if (arg_batch || arg_replay) mstr = "null";
+
 	/* Install "quit" hook */
 	quit_aux = quit_hook;
 
 	/* Try the modules in the order specified by modules[] */
 	for (i = 0; i < (int)N_ELEMENTS(modules); i++)
 	{
+		/* The null module would always work, so it is never a fallback */
+		if (!mstr && streq(modules[i].name, "null")) continue;
+
 		/* User requested a specific module? */
 		if (!mstr || (streq(mstr, modules[i].name)))
 		{
@@ -649,6 +1073,22 @@ int main(int argc, char *argv[])
 	/* Hack -- If requested, display scores and quit */
 	if (show_score > 0) display_scores(0, show_score);
 
+#ifdef SET_UID
+
+	/* Hack -- Play several batch games in parallel (but only one benchmark) */
+	if (arg_batch && !arg_gen_levels && ((last_seed != arg_batch_seed) || (workers > 0)))
+	{
+		if (workers == 0) workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+		if (workers < 1) workers = 1;
+
+		/* A keypress log only holds one game */
+		arg_keylog = NULL;
+
+		batch_farm(arg_batch_seed, last_seed, workers);
+	}
+
+#endif /* SET_UID */
+
 	/* Wait for response */
 	//pause_line(Term->hgt - 1);
 
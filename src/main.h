@@ -27,6 +27,7 @@ extern errr init_lsl(int argc, char **argv);
 extern errr init_ami(int argc, char **argv);
 extern errr init_vme(int argc, char **argv);
 extern errr init_vcs(int argc, char **argv);
+extern errr init_null(int argc, char **argv);
 
 
 extern const char help_xpj[];
@@ -43,6 +44,7 @@ extern const char help_sla[];
 extern const char help_emx[];
 extern const char help_ibm[];
 extern const char help_dos[];
+extern const char help_null[];
 
 
 struct module
@@ -81,6 +81,10 @@ extern int protection_roll(int typ, bool melee)
 	int prt = 0;
 	int mult = 1;
 	int armour_weight = 0;
+	u16b old_stream = Rand_stream;
+	
+	// use the combat random numbers
+	Rand_stream = RAND_STREAM_COMBAT;
 	
 	// things that always count:
 	
@@ -137,6 +141,8 @@ extern int protection_roll(int typ, bool melee)
 		prt += damroll(1, armour_weight / 150);
 	}
 	
+	Rand_stream = old_stream;
+	
 	return prt;
 }
 
@@ -559,19 +559,13 @@ int cave_passable_mon(monster_type *m_ptr, int y, int x, bool *bash)
 {
 	monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-	/* Assume nothing in the grid other than the terrain hinders movement */
-	int move_chance = 100;
+	int move_chance;
 
-	int feat;
-	
 	/* Check Bounds */
 	if (!in_bounds(y, x)) return (0);
 
-	/* Check location */
-	feat = cave_feat[y][x];
-
 	/* Permanent walls are never passable */
-	if (feat == FEAT_WALL_PERM)    return (0);
+	if (cave_feat[y][x] == FEAT_WALL_PERM)    return (0);
 
 	/* The grid is occupied by the player. */
 	if (cave_m_idx[y][x] < 0)
@@ -583,8 +577,33 @@ int cave_passable_mon(monster_type *m_ptr, int y, int x, bool *bash)
 		else return (100);
 	}
 
+	/* See if another monster is in the way */
+	move_chance = cave_passable_occupant(m_ptr, y, x);
+
+	/* Cannot do anything to clear away the other monster */
+	if (move_chance == 0) return (0);
+
+	/* Then check the terrain */
+	return (cave_passable_terrain(m_ptr, y, x, move_chance, bash));
+}
+
+
+/*
+ * How easily can the monster get past another monster in this grid?
+ *
+ * Returns the percentage chance of success, which is 100 if there is
+ * no monster there.  The character's grid is dealt with by
+ * cave_passable_mon().
+ */
+int cave_passable_occupant(monster_type *m_ptr, int y, int x)
+{
+	monster_race *r_ptr = &r_info[m_ptr->r_idx];
+
+	/* Assume nothing in the grid hinders movement */
+	int move_chance = 100;
+
 	/* The grid is occupied by a monster. */
-	else if (cave_m_idx[y][x] > 0)
+	if (cave_m_idx[y][x] > 0)
 	{
 		monster_type *n_ptr = &mon_list[cave_m_idx[y][x]];
 		monster_race *nr_ptr = &r_info[n_ptr->r_idx];
@@ -623,6 +642,34 @@ int cave_passable_mon(monster_type *m_ptr, int y, int x, bool *bash)
 		else return (0);
 	}
 
+	return (move_chance);
+}
+
+
+/*
+ * Can the monster enter this grid, ignoring any creature standing in it?
+ *
+ * Returns the percentage chance of success, capped at 'move_chance', which
+ * is the chance of getting past whatever else is in the grid.
+ *
+ * This depends only on the terrain and on the monster's movement class
+ * (see update_monster_flow()), which lets alert monsters share flows.
+ */
+int cave_passable_terrain(monster_type *m_ptr, int y, int x, int move_chance, bool *bash)
+{
+	monster_race *r_ptr = &r_info[m_ptr->r_idx];
+
+	int feat;
+
+	/* Check Bounds */
+	if (!in_bounds(y, x)) return (0);
+
+	/* Check location */
+	feat = cave_feat[y][x];
+
+	/* Permanent walls are never passable */
+	if (feat == FEAT_WALL_PERM)    return (0);
+
 	/* Glyphs */
 	if (feat == FEAT_GLYPH)
 	{
@@ -1036,6 +1083,15 @@ static bool get_move_wander(monster_type *m_ptr, int *ty, int *tx)
 			
 			dist = flow_dist(m_ptr->wandering_idx, y, x);
 			
+			// the flow ignores monsters, so allow for any monster in the way here
+			if (cave_m_idx[y][x] > 0)
+			{
+				int chance = cave_passable_occupant(m_ptr, y, x);
+				
+				if (chance > 0) dist += (100 / chance) - 1;
+				else            dist = FLOW_MAX_DIST;
+			}
+			
 			// ignore grids that are further than the current favourite
 			if (closest < dist) continue;
             
@@ -1352,7 +1408,7 @@ static bool find_safety(monster_type *m_ptr, int *ty, int *tx)
 static bool get_move_retreat(monster_type *m_ptr, int *ty, int *tx)
 {
 	monster_race *r_ptr = &r_info[m_ptr->r_idx];
-    int m_idx = cave_m_idx[m_ptr->fy][m_ptr->fx];
+    int which_flow = m_ptr->flow;
     
 	int i;
 	int y, x;
@@ -1552,7 +1608,7 @@ static bool get_move_retreat(monster_type *m_ptr, int *ty, int *tx)
 	if (!player_has_los_bold(m_ptr->fy, m_ptr->fx))
 	{
         /* Run away from noise */
-        if (flow_dist(m_idx, m_ptr->fy, m_ptr->fx) < FLOW_MAX_DIST)
+        if (flow_dist(which_flow, m_ptr->fy, m_ptr->fx) < FLOW_MAX_DIST)
         {
             /* Look at adjacent grids, diagonals first */
             for (i = 7; i >= 0; i--)
@@ -1564,7 +1620,7 @@ static bool get_move_retreat(monster_type *m_ptr, int *ty, int *tx)
                 if (!in_bounds(y, x)) continue;
 
                 /* Accept the first non-visible grid with a higher cost */
-                if (flow_dist(m_idx, y, x) > flow_dist(m_idx, m_ptr->fy, m_ptr->fx))
+                if (flow_dist(which_flow, y, x) > flow_dist(which_flow, m_ptr->fy, m_ptr->fx))
                 {
                     if (!player_has_los_bold(y, x))
                     {
@@ -1585,7 +1641,7 @@ static bool get_move_retreat(monster_type *m_ptr, int *ty, int *tx)
 	/* The monster is in line of sight. */
 	else
 	{
-		int prev_dist = flow_dist(m_idx, m_ptr->fy, m_ptr->fx);
+		int prev_dist = flow_dist(which_flow, m_ptr->fy, m_ptr->fx);
 		int start = rand_int(8);
 
 		/* Look for adjacent hiding places */
@@ -1604,11 +1660,11 @@ static bool get_move_retreat(monster_type *m_ptr, int *ty, int *tx)
 			if (cave_passable_mon(m_ptr, y, x, &dummy) < 50) continue;
 
 			/* Accept any grid that doesn't have a lower flow (noise) cost. */
-			if (flow_dist(m_idx, y, x) >= prev_dist)
+			if (flow_dist(which_flow, y, x) >= prev_dist)
 			{
 				*ty = y;
 				*tx = x;
-				prev_dist = flow_dist(m_idx, y, x);
+				prev_dist = flow_dist(which_flow, y, x);
 
 				/* Success */
 				return (TRUE);
@@ -1697,10 +1753,10 @@ static void get_move_advance(monster_type *m_ptr, int *ty, int *tx)
 	monster_race *r_ptr = &r_info[m_ptr->r_idx];
 	monster_lore *l_ptr = &l_list[m_ptr->r_idx];
     
-    int m_idx;
+    int which_flow = m_ptr->flow;
     
 	// Some monsters don't try to pursue when out of sight
-	if ((r_ptr->flags2 & (RF2_TERRITORIAL)) && !los(py, px, m_ptr->fy, m_ptr->fx))
+	if ((r_ptr->flags2 & (RF2_TERRITORIAL)) && !los_from_player(m_ptr->fy, m_ptr->fx))
 	{
         // remember that the monster behaves this
 		l_ptr->flags2 |= (RF2_TERRITORIAL);
@@ -1718,9 +1774,6 @@ static void get_move_advance(monster_type *m_ptr, int *ty, int *tx)
 	y1 = m_ptr->fy;
 	x1 = m_ptr->fx;
     
-    // Monster index
-    m_idx = cave_m_idx[y1][x1];
-    
 	/* Use target information if available */
 	if ((m_ptr->target_y) && (m_ptr->target_x))
 	{
@@ -1731,7 +1784,7 @@ static void get_move_advance(monster_type *m_ptr, int *ty, int *tx)
     
     
 	/* If we can hear noises, advance towards them */
-	if (flow_dist(m_idx, y1, x1) < FLOW_MAX_DIST)
+	if (flow_dist(which_flow, y1, x1) < FLOW_MAX_DIST)
 	{
 		can_use_sound = TRUE;
 	}
@@ -1746,7 +1799,7 @@ static void get_move_advance(monster_type *m_ptr, int *ty, int *tx)
 	if ((!can_use_sound) && (!can_use_scent))
 	{
         // sight but no 'sound' implies blocked by a chasm, so get out of there!
-        if (los(m_ptr->fy, m_ptr->fx, p_ptr->py, p_ptr->px))
+        if (los_to_player(m_ptr->fy, m_ptr->fx))
         {
             get_move_retreat(m_ptr, ty, tx);
             return;
@@ -1785,7 +1838,16 @@ static void get_move_advance(monster_type *m_ptr, int *ty, int *tx)
 		/* We're using sound */
 		else
 		{
-			int dist = flow_dist(m_idx, y, x);
+			int dist = flow_dist(which_flow, y, x);
+            
+			// the flow is shared, so allow for any monster in the way here
+			if (cave_m_idx[y][x] > 0)
+			{
+				int chance = cave_passable_occupant(m_ptr, y, x);
+				
+				if (chance > 0) dist += (100 / chance) - 1;
+				else            dist = FLOW_MAX_DIST;
+			}
             
 			/* Accept louder sounds */
 			if (closest < dist) continue;
@@ -4344,15 +4406,11 @@ void wander(monster_type *m_ptr)
         make_attack_ranged(m_ptr, 96+17);
     }
     
-    // occasionally update the flow (keeping the centre the same)
-    // to take account of changes in the dungeon (new glyphs of warding, doors closed etc)
-    if (one_in_(10))
+    // bring the flow up to date with any changes in the dungeon (new glyphs of warding, doors closed etc)
+    // only do this if they have a real wandering index (not a zero due to too many wandering monster groups)
+    if (m_ptr->wandering_idx >= FLOW_WANDERING_HEAD)
     {
-        // only do this if they have a real wandering index (not a zero due to too many wandering monster groups)
-        if (m_ptr->wandering_idx >= FLOW_WANDERING_HEAD)
-        {
-            update_flow(flow_center_y[m_ptr->wandering_idx], flow_center_x[m_ptr->wandering_idx], m_ptr->wandering_idx);
-        }
+        repair_flow(m_ptr->wandering_idx);
     }
     
 	/* Choose a pair of target grids, or cancel the move. */
@@ -4376,7 +4434,6 @@ static void process_monster(monster_type *m_ptr)
 {
 	monster_race *r_ptr = &r_info[m_ptr->r_idx];
 	monster_lore *l_ptr = &l_list[m_ptr->r_idx];
-    int m_idx = cave_m_idx[m_ptr->fy][m_ptr->fx];
     
 	int i, k, y, x;
 	int ty, tx;
@@ -4464,7 +4521,14 @@ static void process_monster(monster_type *m_ptr)
 	}
 
     // Update monster flow information
-    update_flow(p_ptr->py, p_ptr->px, m_idx);
+    update_monster_flow(m_ptr);
+    
+    // monsters that can reach the player reconsider their targets each turn
+    if (flow_dist(m_ptr->flow, m_ptr->fy, m_ptr->fx) < FLOW_MAX_DIST)
+    {
+        m_ptr->target_y = 0;
+        m_ptr->target_x = 0;
+    }
      
 	/* Calculate the monster's preferred combat range when needed */
 	if (m_ptr->min_range == 0) find_range(m_ptr);
@@ -4498,7 +4562,7 @@ static void process_monster(monster_type *m_ptr)
 	else
 	{
 		// monsters that can see the player are active
-		if (los(m_ptr->fy, m_ptr->fx, p_ptr->py, p_ptr->px)) m_ptr->mflag |= (MFLAG_ACTV);
+		if (los_to_player(m_ptr->fy, m_ptr->fx)) m_ptr->mflag |= (MFLAG_ACTV);
 		
 		// monsters that can hear the player are active (Sil-y: note this is a rather arbitrary calculation)
 		if (flow_dist(FLOW_PLAYER_NOISE, m_ptr->fy, m_ptr->fx) < 20) m_ptr->mflag |= (MFLAG_ACTV);
@@ -5359,7 +5423,7 @@ static void recover_monster(monster_type *m_ptr)
 		p_ptr->redraw |= (PR_HEALTHBAR);
 
 	// Monsters who are out of sight and fail their perception rolls by 25 or more (15 with Vanish) start to lose track of the player
-	if (!los(m_ptr->fy, m_ptr->fx, p_ptr->py, p_ptr->px) && (m_ptr->alertness >= ALERTNESS_ALERT) && 
+	if (!los_to_player(m_ptr->fy, m_ptr->fx) && (m_ptr->alertness >= ALERTNESS_ALERT) && 
 	    (m_ptr->stance != STANCE_FLEEING) && (r_ptr->sleep > 0))
 	{
 		int perception_bonus = p_ptr->active_ability[S_STL][STL_VANISH] ? 15 : 25;
@@ -5398,12 +5462,15 @@ void process_monsters(s16b minimum_energy)
 {
 	int i;
 	monster_type *m_ptr;
+	u16b old_stream = Rand_stream;
 
 	// if time is stopped, no monsters can move
 	if (cheat_timestop) return;
 	
-	/* Process the monsters (backwards) */
-	for (i = mon_max - 1; i >= 1; i--)
+	PROFILE_START(PROF_PROCESS_MONSTERS);
+
+	/* Process the monsters (backwards, as monsters come and go on the way) */
+	for (i = mon_live_prev(mon_max); i >= 1; i = mon_live_prev(i))
 	{
 
 		/* Player is dead or leaving the current level */
@@ -5412,9 +5479,6 @@ void process_monsters(s16b minimum_energy)
 		/* Access the monster */
 		m_ptr = &mon_list[i];
 
-		/* Ignore dead monsters */
-		if (!m_ptr->r_idx) continue;
-
 		/* Leave monsters without enough energy for later */
 		if (m_ptr->energy < minimum_energy) continue;
 
@@ -5440,11 +5504,202 @@ void process_monsters(s16b minimum_energy)
 			continue;
 		}
 
-		/* Let the monster take its turn */
+		/* Let the monster take its turn (with its own random numbers) */
+		Rand_stream = RAND_STREAM_MONSTER;
+		PROFILE_START(PROF_PROCESS_MONSTER);
 		process_monster(m_ptr);
+		PROFILE_STOP(PROF_PROCESS_MONSTER);
+		Rand_stream = old_stream;
 
 	}
 	
+	PROFILE_STOP(PROF_PROCESS_MONSTERS);
+}
+
+
+/*
+ * The monsters that can hear the current noise, and their perception of it
+ * (see "monster_perception()")
+ */
+static GAME_LOCAL s16b perception_idx[MAX_MONSTERS];
+static GAME_LOCAL s16b perception_skill[MAX_MONSTERS];
+
+
+/*
+ * Makes the difficulty roll for a noise, just once per sound source
+ * (i.e. once per call to "monster_perception()").
+ * This is a manual version of a 'skill_check()' and should be treated as such.
+ */
+static int perception_difficulty_roll(bool player_centered, int difficulty)
+{
+	int difficulty_roll;
+	int difficulty_roll_alt;
+	
+	difficulty_roll = difficulty + dieroll(10);
+
+	// deal with player curses for skill rolls
+	// this is not perfect as some 'player_centered' things are not actually caused by the player
+	difficulty_roll_alt = difficulty + dieroll(10);
+	if (p_ptr->cursed && player_centered) difficulty_roll = MIN(difficulty_roll, difficulty_roll_alt);
+	
+	// the song of silence quietens this a bit
+	if (singing(SNG_SILENCE)) difficulty_roll += ability_bonus(S_SNG, SNG_SILENCE);
+
+	return (difficulty_roll);
+}
+
+
+/*
+ * Works out the perception of each monster that can hear a noise, storing
+ * them in "perception_idx" and "perception_skill".
+ * Returns the number of monsters.
+ */
+static int perception_gather(bool player_centered, int combat_noise_bonus, int combat_sight_bonus)
+{
+	int i, d;
+	int num = 0;
+	int m_perception;
+	u32b bane_flag;
+	int bane;
+	int open_squares = 0;
+	int sight_bonus;
+	int noise_dist;
+	monster_type *m_ptr;
+	monster_race *r_ptr;
+
+	// things that only depend on the player are worked out once for all the monsters
+	bane_flag = ((p_ptr->entranced) || (p_ptr->stun > 100)) ? 0L : bane_race_flag();
+	bane = (bane_flag) ? bane_bonus_aux() : 0;
+	
+	// check squares adjacent to the player for impassable squares
+	for (d = 0; d < 8; d++)
+	{
+		if (cave_floor_bold(p_ptr->py + ddy[cycle[d]], p_ptr->px + ddx[cycle[d]])) open_squares++;
+	}
+	
+	// bonus reduced if the player has 'disguise'
+	if (p_ptr->active_ability[S_STL][STL_DISGUISE])	sight_bonus = (open_squares + combat_sight_bonus) / 2;
+	else											sight_bonus = open_squares + combat_sight_bonus;
+	
+	/* Work out the perception of each monster that can hear (backwards) */
+	for (i = mon_live_num - 1; i >= 0; i--)
+	{
+		/* Access the monster */
+		m_ptr = &mon_list[mon_live[i]];
+		
+		// Access the race information
+		r_ptr = &r_info[m_ptr->r_idx];
+	
+		/* If character is within detection range (unlimited for most monsters, 2 for shortsighted ones) */		
+		if ((r_ptr->flags2 & (RF2_SHORT_SIGHTED)) && (m_ptr->cdis > 2)) continue;
+		
+		if (player_centered)
+		{
+			noise_dist = flow_dist(FLOW_PLAYER_NOISE, m_ptr->fy, m_ptr->fx);
+		}
+		else
+		{
+			noise_dist = flow_dist(FLOW_MONSTER_NOISE, m_ptr->fy, m_ptr->fx);
+		}
+		
+		// start building up the monster's total perception
+		m_perception = monster_skill(m_ptr, S_PER) - noise_dist + combat_noise_bonus;
+
+		// deal with bane ability (theoretically should modify player roll, but this is equivalent)
+		if (r_ptr->flags3 & (bane_flag)) m_perception -= bane;
+
+		// increase morale for the Elf-Bane ability
+		m_perception += elf_bane_bonus(m_ptr);
+		
+		// monsters are looking more carefully during the escape
+		if (p_ptr->on_the_run) m_perception += 5;
+		
+		// monsters that are already alert get a penalty to the roll to stop them getting *too* alert
+		if (m_ptr->alertness >= ALERTNESS_ALERT) m_perception -= m_ptr->alertness;
+		
+		// aggravation makes non-sleeping monsters much more likely to notice you
+		if (p_ptr->aggravate && (m_ptr->alertness >= ALERTNESS_UNWARY) && 
+			!(r_ptr->flags2 & (RF2_MINDLESS))) 
+		{
+			m_perception += p_ptr->aggravate * 10;
+		}
+		
+		// awake creatures who have line of sight on player get a bonus
+		if (los_to_player(m_ptr->fy, m_ptr->fx) && (m_ptr->alertness >= ALERTNESS_UNWARY))
+		{
+			m_perception += sight_bonus;
+		}
+		
+		perception_idx[num] = mon_live[i];
+		perception_skill[num] = m_perception;
+		num++;
+	}
+
+	return (num);
+}
+
+
+/*
+ * Rolls for each of the first 'num' monsters gathered by "perception_gather()"
+ * to notice a noise of the given difficulty (with the difficulty roll made).
+ * Returns the number of monsters that noticed something.
+ */
+static int perception_rolls(int num, int difficulty, int difficulty_roll)
+{
+	int i;
+	int noticed = 0;
+	int m_perception;
+	int result;
+	monster_type *m_ptr;
+	monster_lore *l_ptr;
+
+	for (i = 0; i < num; i++)
+	{
+		m_ptr = &mon_list[perception_idx[i]];
+		l_ptr = &l_list[m_ptr->r_idx];
+		m_perception = perception_skill[i];
+		
+		// do the 'skill_check()' versus the quietness of the sound...
+		result = (m_perception + dieroll(10)) - difficulty_roll;
+
+		/* Debugging message */
+		if (cheat_skill_rolls)
+		{
+			msg_format("{%d+%d v %d+%d = %d}.", result - m_perception + difficulty_roll, m_perception, 
+					   difficulty_roll - difficulty, difficulty,
+					   result);
+		}
+		
+		if (result > 0)
+		{					
+			noticed++;
+
+			// Partly alert monster
+			set_alertness(m_ptr, m_ptr->alertness + result);
+								
+			/* Still not alert */
+			if (m_ptr->alertness < ALERTNESS_ALERT)
+			{
+				/* Notice the "not noticing" */
+				if (m_ptr->ml && (l_ptr->ignore < MAX_UCHAR))
+				{
+					l_ptr->ignore++;
+				}
+			}
+			
+			/* Just became alert */
+			else
+			{
+				/* Notice the "noticing" */
+				if (m_ptr->ml && (l_ptr->notice < MAX_UCHAR))
+				{
+					l_ptr->notice++;
+				}
+			}
+		}
+	}
+
+	return (noticed);
 }
 
 
@@ -5456,19 +5711,17 @@ void process_monsters(s16b minimum_energy)
  * These events can be caused by the player (in which case 'player_centered' is set to true),
  * or can be caused by a monster, in which case it will be false and FLOW_MONSTER_NOISE will be used
  * instead of the usual FLOW_PLAYER_NOISE.
+ *
+ * The perception of every monster that can hear is worked out first, with
+ * everything that only depends on the player worked out just once, and then
+ * the rolls are made for them all in a second pass (in the same order as
+ * ever, so the results don't change).
  */
 
 void monster_perception(bool player_centered, bool main_roll, int difficulty)
 {
-	int i;
-	int m_perception;
-	int result;
-	int noise_dist;
-	monster_type *m_ptr;
-	monster_race *r_ptr;
-	monster_lore *l_ptr;
+	int num;
 	int difficulty_roll;
-	int difficulty_roll_alt;
 		
 	int combat_noise_bonus = 0;
 	int combat_sight_bonus = 0;
@@ -5523,132 +5776,52 @@ void monster_perception(bool player_centered, bool main_roll, int difficulty)
 		//c_put_str(attr, buf, ROW_STEALTH, COL_STEALTH);
 	}
 	
-	// make the difficulty roll just once per sound source
-	// i.e. once per call to this function
-	// this is a manual version of a 'skill_check()' and should be treated as such
-	difficulty_roll = difficulty + dieroll(10);
+	difficulty_roll = perception_difficulty_roll(player_centered, difficulty);
 
-	// deal with player curses for skill rolls
-	// this is not perfect as some 'player_centered' things are not actually caused by the player
-	difficulty_roll_alt = difficulty + dieroll(10);
-	if (p_ptr->cursed && player_centered) difficulty_roll = MIN(difficulty_roll, difficulty_roll_alt);
+	/* Work out the perception of each monster that can hear */
+	num = perception_gather(player_centered, combat_noise_bonus, combat_sight_bonus);
 	
-	// the song of silence quietens this a bit
-	if (singing(SNG_SILENCE)) difficulty_roll += ability_bonus(S_SNG, SNG_SILENCE);
+	/* Then roll for them all, in the same order */
+	(void)perception_rolls(num, difficulty, difficulty_roll);
+}
 
-	/* Process the monsters (backwards) */
-	for (i = mon_max - 1; i >= 1; i--)
-	{
-		/* Access the monster */
-		m_ptr = &mon_list[i];
-		
-		// Access the race and lore information
-		r_ptr = &r_info[m_ptr->r_idx];
-		l_ptr = &l_list[m_ptr->r_idx];
-		
-		/* Ignore dead monsters */
-		if (!m_ptr->r_idx) continue;
-	
-		/* If character is within detection range (unlimited for most monsters, 2 for shortsighted ones) */		
-		if (!((r_ptr->flags2 & (RF2_SHORT_SIGHTED)) && (m_ptr->cdis > 2)))
-		{
-			if (player_centered)
-			{
-				noise_dist = flow_dist(FLOW_PLAYER_NOISE, m_ptr->fy, m_ptr->fx);
-			}
-			else
-			{
-				noise_dist = flow_dist(FLOW_MONSTER_NOISE, m_ptr->fy, m_ptr->fx);
-			}
-			
-			// start building up the monster's total perception
-			m_perception = monster_skill(m_ptr, S_PER) - noise_dist + combat_noise_bonus;
 
-			// deal with bane ability (theoretically should modify player roll, but this is equivalent)
-			m_perception -= bane_bonus(m_ptr);
+/*
+ * Gets the main perception roll ready for a player who is keeping still and
+ * quiet for a number of turns at once (see "rest_in_bulk()").  Nothing the
+ * rolls depend on changes in that time, so the monsters are gathered just
+ * once, leaving out any that couldn't notice even the quietest roll.
+ * Returns the number of monsters that might notice.
+ */
+int quiet_perception_gather(int difficulty)
+{
+	int i;
+	int num;
+	int left = 0;
 
-            // increase morale for the Elf-Bane ability
-            m_perception += elf_bane_bonus(m_ptr);
-            
-			// monsters are looking more carefully during the escape
-			if (p_ptr->on_the_run) m_perception += 5;
-			
-			// monsters that are already alert get a penalty to the roll to stop them getting *too* alert
-			if (m_ptr->alertness >= ALERTNESS_ALERT) m_perception -= m_ptr->alertness;
-			
-			// aggravation makes non-sleeping monsters much more likely to notice you
-			if (p_ptr->aggravate && (m_ptr->alertness >= ALERTNESS_UNWARY) && 
-				!(r_ptr->flags2 & (RF2_MINDLESS))) 
-			{
-				m_perception += p_ptr->aggravate * 10;
-			}
-							
-			// awake creatures who have line of sight on player get a bonus
-			if (los(m_ptr->fy, m_ptr->fx, p_ptr->py, p_ptr->px) && (m_ptr->alertness >= ALERTNESS_UNWARY))
-			{
-				int d, dir, y, x, open_squares = 0;
-			                
-				// check adjacent squares for impassable squares
-				for (d = 0; d < 8; d++)
-				{
-					dir = cycle[d];
-					
-					y = p_ptr->py + ddy[dir];
-					x = p_ptr->px + ddx[dir];
-					
-					if (cave_floor_bold(y,x))
-					{
-						open_squares++;
-					}
-				}
-				
-				// bonus reduced if the player has 'disguise'
-				if (p_ptr->active_ability[S_STL][STL_DISGUISE])
-				{
-					m_perception += (open_squares + combat_sight_bonus) / 2;
-				}
-				else
-				{
-					m_perception += open_squares + combat_sight_bonus;
-				}
-			}
-			
-			// do the 'skill_check()' versus the quietness of the sound...
-			result = (m_perception + dieroll(10)) - difficulty_roll;
+	num = perception_gather(TRUE, 0, 0);
 
-			/* Debugging message */
-			if (cheat_skill_rolls)
-			{
-				msg_format("{%d+%d v %d+%d = %d}.", result - m_perception + difficulty_roll, m_perception, 
-						   difficulty_roll - difficulty, difficulty,
-						   result);
-			}
-			
-			if (result > 0)
-			{					
-				// Partly alert monster
-				set_alertness(m_ptr, m_ptr->alertness + result);
-									
-				/* Still not alert */
-				if (m_ptr->alertness < ALERTNESS_ALERT)
-				{
-					/* Notice the "not noticing" */
-					if (m_ptr->ml && (l_ptr->ignore < MAX_UCHAR))
-					{
-						l_ptr->ignore++;
-					}
-				}
-				
-				/* Just became alert */
-				else
-				{
-					/* Notice the "noticing" */
-					if (m_ptr->ml && (l_ptr->notice < MAX_UCHAR))
-					{
-						l_ptr->notice++;
-					}
-				}
-			}
-		}
+	for (i = 0; i < num; i++)
+	{
+		// the difficulty roll is always more than the difficulty
+		if (perception_skill[i] + 10 <= difficulty + 1) continue;
+
+		perception_idx[left] = perception_idx[i];
+		perception_skill[left] = perception_skill[i];
+		left++;
 	}
+
+	return (left);
+}
+
+
+/*
+ * Makes one turn's main perception roll for the monsters gathered by
+ * "quiet_perception_gather()".  Returns TRUE if any of them noticed.
+ */
+bool quiet_perception_roll(int num, int difficulty)
+{
+	if (num == 0) return (FALSE);
+
+	return (perception_rolls(num, difficulty, perception_difficulty_roll(TRUE, difficulty)) > 0);
 }
@@ -115,6 +115,126 @@ s16b poly_r_idx(const monster_type *m_ptr)
 
 
 
+/*
+ * The live monsters
+ *
+ * "mon_live" holds the indexes of all the monsters with a race, in order of
+ * increasing index, so that the sweeps over every monster needn't step over
+ * the dead ones.  It is kept up to date by "monster_place()",
+ * "delete_monster_idx()", "compact_monsters_aux()" and "wipe_mon_list()".
+ *
+ * Sweeps which can't create or delete monsters may simply run along
+ * "mon_live[0..mon_live_num-1]".  Those which can should step from one
+ * monster to the next with "mon_live_prev()" instead.
+ */
+
+
+/*
+ * Find where the index 'm_idx' belongs in the live monsters
+ */
+static int mon_live_pos(int m_idx)
+{
+	int lo = 0, hi = mon_live_num;
+
+	/* Binary search */
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+
+		if (mon_live[mid] < m_idx) lo = mid + 1;
+		else hi = mid;
+	}
+
+	return (lo);
+}
+
+
+/*
+ * Add the monster 'm_idx' to the live monsters
+ */
+static void mon_live_add(int m_idx)
+{
+	int n = mon_live_pos(m_idx);
+
+	/* Make room */
+	if (n < mon_live_num)
+	{
+		(void)memmove(&mon_live[n + 1], &mon_live[n], (mon_live_num - n) * sizeof(s16b));
+	}
+
+	mon_live[n] = m_idx;
+	mon_live_num++;
+}
+
+
+/*
+ * Remove the monster 'm_idx' from the live monsters
+ */
+static void mon_live_remove(int m_idx)
+{
+	int n = mon_live_pos(m_idx);
+
+	/* Paranoia */
+	if ((n >= mon_live_num) || (mon_live[n] != m_idx)) return;
+
+	mon_live_num--;
+
+	/* Close the gap */
+	if (n < mon_live_num)
+	{
+		(void)memmove(&mon_live[n], &mon_live[n + 1], (mon_live_num - n) * sizeof(s16b));
+	}
+}
+
+
+/*
+ * Return the highest index of a live monster below 'm_idx', or 0 if none.
+ *
+ * This visits the same monsters as counting down through "mon_list" and
+ * skipping the dead ones, even if monsters are created or deleted on the way.
+ */
+s16b mon_live_prev(int m_idx)
+{
+	int n = mon_live_pos(m_idx);
+
+	return ((n > 0) ? mon_live[n - 1] : 0);
+}
+
+
+/*
+ * Monster handles
+ *
+ * A monster keeps its index for as long as it lives (unless the list is
+ * compacted because it is nearly full, or for saving), but the index is
+ * handed on to a new monster once it has died.  Anything that remembers a
+ * monster from one turn to the next can keep a handle instead, which is the
+ * index together with the "generation" of that entry of "mon_list", and
+ * stops being valid as soon as the monster dies or is moved.
+ */
+u32b mon_handle(int m_idx)
+{
+	return (((u32b)mon_gen[m_idx] << 16) | (u32b)m_idx);
+}
+
+
+/*
+ * Return the index of the monster with the given handle, or 0 if it has gone
+ */
+s16b mon_handle_idx(u32b handle)
+{
+	int m_idx = (int)(handle & 0xFFFF);
+
+	/* Not a monster */
+	if ((m_idx <= 0) || (m_idx >= mon_max)) return (0);
+
+	/* Dead, or replaced by another one */
+	if (!mon_list[m_idx].r_idx) return (0);
+	if (mon_gen[m_idx] != ((handle >> 16) & 0xFFFF)) return (0);
+
+	return (m_idx);
+}
+
+
 /*
  * Delete a monster by index.
  *
@@ -123,6 +243,7 @@ s16b poly_r_idx(const monster_type *m_ptr)
 void delete_monster_idx(int i)
 {
 	int x, y;
+	int j;
 
 	monster_type *m_ptr = &mon_list[i];
 	monster_race *r_ptr = &r_info[m_ptr->r_idx];
@@ -137,6 +258,7 @@ void delete_monster_idx(int i)
 
 	/* Hack -- Reduce the racial counter */
 	r_ptr->cur_num--;
+	if (r_ptr->cur_num + 1 == r_ptr->max_num) alloc_race_version++;
 
 	/* Hack -- count the number of "reproducers" */
 	if (r_ptr->flags2 & (RF2_MULTIPLY)) num_repro--;
@@ -169,12 +291,29 @@ void delete_monster_idx(int i)
 		delete_object_idx(this_o_idx);
 	}
 
+	/* The last of a wandering group no longer needs the group's flow */
+	if (m_ptr->wandering_idx >= FLOW_WANDERING_HEAD)
+	{
+		for (j = 1; j < mon_max; j++)
+		{
+			if (j == i) continue;
+			if (mon_list[j].r_idx && (mon_list[j].wandering_idx == m_ptr->wandering_idx)) break;
+		}
+
+		if (j == mon_max) release_flow(m_ptr->wandering_idx);
+	}
+
 
 	/* Wipe the Monster */
 	(void)WIPE(m_ptr, monster_type);
 
 	/* Count monsters */
 	mon_cnt--;
+	mon_live_remove(i);
+
+	/* The entry is free for another monster */
+	mon_gen[i]++;
+	mon_free[mon_free_num++] = i;
 
 
 	/* Visual update */
@@ -247,6 +386,13 @@ static void compact_monsters_aux(int i1, int i2)
 
 	/* Hack -- wipe hole */
 	(void)WIPE(&mon_list[i1], monster_type);
+
+	/* Move it in the live monsters */
+	mon_live_remove(i1);
+	mon_live_add(i2);
+
+	/* Handles to the old entry are no longer valid */
+	mon_gen[i1]++;
 }
 
 
@@ -384,6 +530,9 @@ void compact_monsters(int size)
 		/* Compress "mon_max" */
 		mon_max--;
 	}
+
+	/* There are no holes left */
+	mon_free_num = 0;
 }
 
 
@@ -408,12 +557,14 @@ void wipe_mon_list(void)
 
 		/* Hack -- Reduce the racial counter */
 		r_ptr->cur_num--;
+		if (r_ptr->cur_num + 1 == r_ptr->max_num) alloc_race_version++;
 
 		/* Monster is gone */
 		cave_m_idx[m_ptr->fy][m_ptr->fx] = 0;
 
 		/* Wipe the Monster */
 		(void)WIPE(m_ptr, monster_type);
+		mon_gen[i]++;
 	}
 
 	/* Reset "mon_max" */
@@ -422,6 +573,10 @@ void wipe_mon_list(void)
 	/* Reset "mon_cnt" */
 	mon_cnt = 0;
 
+	/* No live monsters, and no holes */
+	mon_live_num = 0;
+	mon_free_num = 0;
+
 	/* Hack -- reset "reproducer" count */
 	num_repro = 0;
 
@@ -445,38 +600,32 @@ s16b mon_pop(void)
 {
 	int i;
 
-	/* Normal allocation */
-	if (mon_max < MAX_MONSTERS)
+	/* Fill a hole left by a dead monster */
+	if (mon_free_num > 0)
 	{
-		/* Get the next hole */
-		i = mon_max;
-
-		/* Expand the array */
-		mon_max++;
+		/* Take the most recent hole */
+		i = mon_free[--mon_free_num];
 
 		/* Count monsters */
 		mon_cnt++;
 
-		/* Return the index */
+		/* Use this monster */
 		return (i);
 	}
 
-
-	/* Recycle dead monsters */
-	for (i = 1; i < mon_max; i++)
+	/* Normal allocation */
+	if (mon_max < MAX_MONSTERS)
 	{
-		monster_type *m_ptr;
-
-		/* Get the monster */
-		m_ptr = &mon_list[i];
+		/* Get the next hole */
+		i = mon_max;
 
-		/* Skip live monsters */
-		if (m_ptr->r_idx) continue;
+		/* Expand the array */
+		mon_max++;
 
 		/* Count monsters */
 		mon_cnt++;
 
-		/* Use this monster */
+		/* Return the index */
 		return (i);
 	}
 
@@ -517,12 +666,55 @@ errr get_mon_num_prep(void)
 		}
 	}
 
+	/* The chances have changed */
+	alloc_race_version++;
+
 	/* Success */
 	return (0);
 }
 
 
 
+/*
+ * Determine if a monster race may be chosen by "get_mon_num()"
+ */
+static bool mon_num_allowed(const alloc_entry *entry, const monster_race *r_ptr, int generation_level,
+                            bool special, bool allow_non_smart, bool pursuing_monster)
+{
+	/* Unless in 'special' generation, ignore monsters before the appropriate level */
+	if (!special && (entry->level < generation_level)) return (FALSE);
+
+	/* Even in 'special' generation, ignore monsters before 1/2 the appropriate level */
+	if (special && (entry->level <= generation_level / 2)) return (FALSE);
+
+	/* Ignore monsters which are too prolific */
+	if (r_ptr->cur_num >= r_ptr->max_num) return (FALSE);
+	
+	/* Forced depth monsters never appear out of depth */
+	if ((r_ptr->flags1 & (RF1_FORCE_DEPTH)) && (r_ptr->level > p_ptr->depth))
+	{
+		return (FALSE);
+	}
+
+	/* Non-moving monsters can't appear as out-of-depth pursuing monsters */
+	if ((r_ptr->flags1 & (RF1_NEVER_MOVE)) && pursuing_monster)
+	{
+		return (FALSE);
+	}
+
+	/* Territorial monsters can't appear as out-of-depth pursuing monsters */
+	if ((r_ptr->flags2 & (RF2_TERRITORIAL)) && pursuing_monster)
+	{
+		return (FALSE);
+	}
+
+	// forbid the generation of non-smart monsters except at level-creation or specific summons
+	if (!allow_non_smart && !((r_ptr->flags2 & (RF2_SMART)) && !(r_ptr->flags2 & (RF2_TERRITORIAL)))) return (FALSE);
+
+	return (TRUE);
+}
+
+
 /*
  * Choose a monster race that seems "appropriate" to the given level
  *
@@ -555,9 +747,20 @@ errr get_mon_num_prep(void)
  *
  * Sil-y: note that most of the above is very out of date now
  *
+ * The "prob3" and running "total" fields are only worked out again when they
+ * would come out differently: for a new level or kind of monster, or when
+ * "alloc_race_version" has changed.
  */
 s16b get_mon_num(int level, bool special, bool allow_non_smart, bool vault)
 {
+	static GAME_LOCAL int last_level = -1;
+	static GAME_LOCAL int last_depth;
+	static GAME_LOCAL byte last_flags;
+	static GAME_LOCAL u32b last_version;
+	static GAME_LOCAL int last_size;
+
+	byte flags;
+
 	int i;
 
 	int r_idx;
@@ -643,76 +846,58 @@ s16b get_mon_num(int level, bool special, bool allow_non_smart, bool vault)
 		if (generation_level > MORGOTH_DEPTH + 3) generation_level = MORGOTH_DEPTH + 3;
 	}
 
-	/* Reset total */
-	total = 0L;
+	flags = (special ? 0x01 : 0) | (allow_non_smart ? 0x02 : 0) | (pursuing_monster ? 0x04 : 0);
 
-	/* Process probabilities */
-	for (i = 0; i < alloc_race_size; i++)
+	/* The table needs working out again */
+	if ((generation_level != last_level) || (p_ptr->depth != last_depth) ||
+	    (flags != last_flags) || (alloc_race_version != last_version))
 	{
-		/* Monsters are sorted by depth */
-		if (table[i].level > generation_level) break;
-
-		/* Default */
-		table[i].prob3 = 0;
+		/* Reset total */
+		total = 0L;
 
-		/* Get the "r_idx" of the chosen monster */
-		r_idx = table[i].index;
-
-		/* Get the actual race */
-		r_ptr = &r_info[r_idx];
+		/* Process probabilities */
+		for (i = 0; i < alloc_race_size; i++)
+		{
+			/* Monsters are sorted by depth */
+			if (table[i].level > generation_level) break;
 
-		/* Unless in 'special' generation, ignore monsters before the appropriate level */
-		if (!special && (table[i].level < generation_level)) continue;
+			/* Default */
+			table[i].prob3 = 0;
 
-		/* Even in 'special' generation, ignore monsters before 1/2 the appropriate level */
-		if (special && (table[i].level <= generation_level / 2)) continue;
+			/* Get the "r_idx" of the chosen monster */
+			r_idx = table[i].index;
 
-		/* Ignore monsters which are too prolific */
-		if (r_ptr->cur_num >= r_ptr->max_num) continue;
-		
-		/* Forced depth monsters never appear out of depth */
-		if ((r_ptr->flags1 & (RF1_FORCE_DEPTH)) && (r_ptr->level > p_ptr->depth))
-		{
-			continue;
-		}
+			/* Get the actual race */
+			r_ptr = &r_info[r_idx];
 
-		/* Non-moving monsters can't appear as out-of-depth pursuing monsters */
-		if ((r_ptr->flags1 & (RF1_NEVER_MOVE)) && pursuing_monster)
-		{
-			continue;
-		}
+			if (mon_num_allowed(&table[i], r_ptr, generation_level, special, allow_non_smart, pursuing_monster))
+			{
+				/* Accept */
+				table[i].prob3 = table[i].prob2;
+			}
 
-        /* Territorial monsters can't appear as out-of-depth pursuing monsters */
-		if ((r_ptr->flags2 & (RF2_TERRITORIAL)) && pursuing_monster)
-		{
-			continue;
+			/* Total */
+			total += table[i].prob3;
+			table[i].total = total;
 		}
 
-		// forbid the generation of non-smart monsters except at level-creation or specific summons
-		if (!allow_non_smart && !((r_ptr->flags2 & (RF2_SMART)) && !(r_ptr->flags2 & (RF2_TERRITORIAL)))) continue;
-
-		/* Accept */
-		table[i].prob3 = table[i].prob2;
-
-		/* Total */
-		total += table[i].prob3;
+		last_level = generation_level;
+		last_depth = p_ptr->depth;
+		last_flags = flags;
+		last_version = alloc_race_version;
+		last_size = i;
 	}
 
 	/* No legal monsters */
+	if (!last_size) return (0);
+	total = table[last_size - 1].total;
 	if (total <= 0) return (0);
 
 	/* Pick a monster */
 	value = rand_int(total);
 
 	/* Find the monster */
-	for (i = 0; i < alloc_race_size; i++)
-	{
-		/* Found the entry */
-		if (value < table[i].prob3) break;
-
-		/* Decrement */
-		value = value - table[i].prob3;
-	}
+	i = alloc_table_find(table, last_size, value);
 
 	/* Result */
 	return (table[i].index);
@@ -1615,6 +1800,8 @@ void update_monsters(bool full)
 {
 	int i;
 
+	PROFILE_START(PROF_UPDATE_MONSTERS);
+
 	/* Update each (live) monster */
 	for (i = 1; i < mon_max; i++)
 	{
@@ -1626,6 +1813,8 @@ void update_monsters(bool full)
 		/* Update the monster */
 		update_mon(i, full);
 	}
+
+	PROFILE_STOP(PROF_UPDATE_MONSTERS);
 }
 
 
@@ -2092,6 +2281,9 @@ s16b monster_place(int y, int x, monster_type *n_ptr)
 		m_ptr->fy = y;
 		m_ptr->fx = x;
 
+		/* It is alive */
+		mon_live_add(m_idx);
+
 		/* Update the monster */
 		update_mon(m_idx, TRUE);
 
@@ -2106,6 +2298,7 @@ s16b monster_place(int y, int x, monster_type *n_ptr)
 
 		/* Count racial occurances */
 		r_ptr->cur_num++;
+		if (r_ptr->cur_num == r_ptr->max_num) alloc_race_version++;
 	}
 
 	/* Result */
@@ -2521,7 +2714,7 @@ static bool place_monster_group(int y, int x, int r_idx, bool slp, monster_type
 /*
  * Hack -- help pick an escort type
  */
-static int place_monster_idx = 0;
+static GAME_LOCAL int place_monster_idx = 0;
 
 /*
  * Hack -- help pick an escort type
@@ -3058,7 +3251,7 @@ bool alloc_monster(bool on_stairs, bool force_undead)
 /*
  * Hack -- the "type" of the current "summon specific"
  */
-static int summon_specific_type = 0;
+static GAME_LOCAL int summon_specific_type = 0;
 
 
 /*
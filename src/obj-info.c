@@ -11,7 +11,7 @@
 #include "angband.h"
 
 /* TRUE if a paragraph break should be output before next p_text_out() */
-static bool new_paragraph = FALSE;
+static GAME_LOCAL bool new_paragraph = FALSE;
 
 
 static void p_text_out(cptr str)
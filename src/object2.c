@@ -165,6 +165,9 @@ void delete_object_idx(int o_idx)
 
 	/* Count objects */
 	o_cnt--;
+
+	/* The entry is free for another object */
+	o_free[o_free_num++] = o_idx;
 }
 
 
@@ -195,6 +198,9 @@ void delete_object(int y, int x)
 
 		/* Count objects */
 		o_cnt--;
+
+		/* The entry is free for another object */
+		o_free[o_free_num++] = this_o_idx;
 	}
 
 	/* Objects are gone */
@@ -405,6 +411,9 @@ void compact_objects(int size)
 		/* Compress "o_max" */
 		o_max--;
 	}
+
+	/* There are no holes left */
+	o_free_num = 0;
 }
 
 
@@ -480,6 +489,9 @@ void wipe_o_list(void)
 
 	/* Reset "o_cnt" */
 	o_cnt = 0;
+
+	/* No holes */
+	o_free_num = 0;
 }
 
 
@@ -494,14 +506,11 @@ s16b o_pop(void)
 	int i;
 
 
-	/* Initial allocation */
-	if (o_max < z_info->o_max)
+	/* Fill a hole left by a deleted object */
+	if (o_free_num > 0)
 	{
-		/* Get next space */
-		i = o_max;
-
-		/* Expand object array */
-		o_max++;
+		/* Take the most recent hole */
+		i = o_free[--o_free_num];
 
 		/* Count objects */
 		o_cnt++;
@@ -511,16 +520,14 @@ s16b o_pop(void)
 	}
 
 
-	/* Recycle dead objects */
-	for (i = 1; i < o_max; i++)
+	/* Initial allocation */
+	if (o_max < z_info->o_max)
 	{
-		object_type *o_ptr;
-
-		/* Get the object */
-		o_ptr = &o_list[i];
+		/* Get next space */
+		i = o_max;
 
-		/* Skip live objects */
-		if (o_ptr->k_idx) continue;
+		/* Expand object array */
+		o_max++;
 
 		/* Count objects */
 		o_cnt++;
@@ -594,12 +601,37 @@ errr get_obj_num_prep(void)
 		}
 	}
 
+	/* The chances have changed */
+	alloc_kind_version++;
+
 	/* Success */
 	return (0);
 }
 
 
 
+/*
+ * Find the entry of an allocation table that a random "value" (less than the
+ * last "total") falls in, which is the first one whose running total is more
+ * than it (this is the same entry that subtracting each "prob3" in turn
+ * would find).
+ */
+int alloc_table_find(const alloc_entry *table, int size, long value)
+{
+	int lo = 0, hi = size - 1;
+
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+
+		if (value < table[mid].total) hi = mid;
+		else lo = mid + 1;
+	}
+
+	return (lo);
+}
+
+
 /*
  * Choose an object kind that seems "appropriate" to the given level
  *
@@ -615,9 +647,17 @@ errr get_obj_num_prep(void)
  * Note that if no objects are "appropriate", then this function will
  * fail, and return zero, but this should *almost* never happen.
  * (but it does happen with certain themed items occasionally). -JG
+ *
+ * The "prob3" and running "total" fields are only worked out again when they
+ * would come out differently, for a new level or restriction.
  */
 s16b get_obj_num(int level)
 {
+	static GAME_LOCAL int last_level = -1;
+	static GAME_LOCAL byte last_mode;
+	static GAME_LOCAL u32b last_version;
+	static GAME_LOCAL int last_size;
+
 	int i, j, p;
 
 	int k_idx;
@@ -651,50 +691,57 @@ s16b get_obj_num(int level)
 		}
 	}
 
-	/* Reset total */
-	total = 0L;
-
-	/* Process probabilities */
-	for (i = 0; i < alloc_kind_size; i++)
+	/* The table needs working out again */
+	if ((level != last_level) || (object_generation_mode != last_mode) ||
+	    (alloc_kind_version != last_version))
 	{
-		/* Objects are sorted by depth */
-		if (table[i].level > level) break;
+		/* Reset total */
+		total = 0L;
 
-		/* Default */
-		table[i].prob3 = 0;
+		/* Process probabilities */
+		for (i = 0; i < alloc_kind_size; i++)
+		{
+			/* Objects are sorted by depth */
+			if (table[i].level > level) break;
 
-		/* Get the index */
-		k_idx = table[i].index;
+			/* Default */
+			table[i].prob3 = 0;
 
-		/* Get the actual kind */
-		k_ptr = &k_info[k_idx];
+			/* Get the index */
+			k_idx = table[i].index;
 
-		/* Hack -- prevent embedded chests*/
-		if ((object_generation_mode == OB_GEN_MODE_CHEST)
-			    && (k_ptr->tval == TV_CHEST)) continue;
+			/* Get the actual kind */
+			k_ptr = &k_info[k_idx];
 
-		/* Accept */
-		table[i].prob3 = table[i].prob2;
+			/* Hack -- prevent embedded chests*/
+			if ((object_generation_mode != OB_GEN_MODE_CHEST)
+			    || (k_ptr->tval != TV_CHEST))
+			{
+				/* Accept */
+				table[i].prob3 = table[i].prob2;
+			}
 
-		/* Total */
-		total += table[i].prob3;
+			/* Total */
+			total += table[i].prob3;
+			table[i].total = total;
+		}
+
+		last_level = level;
+		last_mode = object_generation_mode;
+		last_version = alloc_kind_version;
+		last_size = i;
 	}
 
 	/* No legal objects */
+	if (!last_size) return (0);
+	total = table[last_size - 1].total;
 	if (total <= 0) return (0);
 
 	/* Pick an object */
 	value = rand_int(total);
 
 	/* Find the object */
-	for (i = 0; i < alloc_kind_size; i++)
-	{
-		/* Found the entry */
-		if (value < table[i].prob3) break;
-
-		/* Decrement */
-		value = value - table[i].prob3;
-	}
+	i = alloc_table_find(table, last_size, value);
 
 
 	/* Power boost */
@@ -709,15 +756,8 @@ s16b get_obj_num(int level)
 		/* Pick a object */
 		value = rand_int(total);
 
-		/* Find the monster */
-		for (i = 0; i < alloc_kind_size; i++)
-		{
-			/* Found the entry */
-			if (value < table[i].prob3) break;
-
-			/* Decrement */
-			value = value - table[i].prob3;
-		}
+		/* Find the object */
+		i = alloc_table_find(table, last_size, value);
 
 		/* Keep the "best" one */
 		if (table[i].level < table[j].level) i = j;
@@ -733,14 +773,7 @@ s16b get_obj_num(int level)
 		value = rand_int(total);
 
 		/* Find the object */
-		for (i = 0; i < alloc_kind_size; i++)
-		{
-			/* Found the entry */
-			if (value < table[i].prob3) break;
-
-			/* Decrement */
-			value = value - table[i].prob3;
-		}
+		i = alloc_table_find(table, last_size, value);
 
 		/* Keep the "best" one */
 		if (table[i].level < table[j].level) i = j;
@@ -1399,15 +1432,49 @@ void object_absorb(object_type *o_ptr, object_type *j_ptr)
 
 
 
+/*
+ * The hash of a tval and sval, for "k_index"
+ */
+#define KIND_HASH(T,S)	hash_number(((u32b)(T) << 8) | (byte)(S))
+
+
+/*
+ * Build "k_index" from the object kinds
+ *
+ * The tvals and svals never change, so one index serves every game.
+ */
+void index_kinds(void)
+{
+	int k;
+
+	/* Forget any old index */
+	KILL(k_index.slot);
+
+	/* Make an empty one */
+	k_index.size = index_table_size(z_info->k_max);
+	C_MAKE(k_index.slot, k_index.size, u16b);
+
+	/* Add the kinds in order, so the first of any duplicates is found */
+	for (k = 1; k < z_info->k_max; k++)
+	{
+		object_kind *k_ptr = &k_info[k];
+
+		index_table_add(&k_index, KIND_HASH(k_ptr->tval, k_ptr->sval), k);
+	}
+}
+
+
 /*
  * Find the index of the object_kind with the given tval and sval
  */
 s16b lookup_kind(int tval, int sval)
 {
+	u32b hash = KIND_HASH(tval, sval);
+	u32b probe = 0;
 	int k;
 
 	/* Look for it */
-	for (k = 1; k < z_info->k_max; k++)
+	while ((k = index_table_find(&k_index, hash, &probe)) >= 0)
 	{
 		object_kind *k_ptr = &k_info[k];
 
@@ -3300,7 +3367,7 @@ static bool kind_is_good(int k_idx)
  *
  * We assume that the given object has been "wiped".
  */
-bool make_object(object_type *j_ptr, bool good, bool great, int objecttype)
+static bool make_object_aux(object_type *j_ptr, bool good, bool great, int objecttype)
 {
 	int prob, base;
 	bool generated_special = FALSE;
@@ -3449,6 +3516,24 @@ bool make_object(object_type *j_ptr, bool good, bool great, int objecttype)
 }
 
 
+/*
+ * Attempt to make an object, using the random numbers set aside for objects
+ */
+bool make_object(object_type *j_ptr, bool good, bool great, int objecttype)
+{
+	u16b old_stream = Rand_stream;
+	bool made;
+
+	Rand_stream = RAND_STREAM_OBJECT;
+
+	made = make_object_aux(j_ptr, good, great, objecttype);
+
+	Rand_stream = old_stream;
+
+	return (made);
+}
+
+
 /*
  * Set the object theme
  */
@@ -138,7 +138,7 @@ static const byte table_type_freq[ART_TYPE_MAX][CAT_MAX] =
 
 
 /*used to hold the frequencies for the above table for the current randart*/
-static u16b art_freq[CAT_MAX];
+static GAME_LOCAL u16b art_freq[CAT_MAX];
 
 /*
  *This list is sliightly different than the artefact type list above.
@@ -187,7 +187,7 @@ static const byte theme_type[ART_THEME_MAX][COL_MAX] =
 	{4,  3,  DROP_TYPE_BOOTS}  		/*  ART_THEME_BOOTS   	*/
 };
 
-static int art_theme_freq[ART_THEME_MAX];
+static GAME_LOCAL int art_theme_freq[ART_THEME_MAX];
 
 
 
@@ -216,7 +216,7 @@ static const byte table_stat_freq[ART_TYPE_MAX][A_MAX] =
 };
 
 /*Current randart only - Used to keep weightings for each stat*/
-static byte art_stat_freq[A_MAX];
+static GAME_LOCAL byte art_stat_freq[A_MAX];
 
 /*
  * Frequencies of "higher" resists and immunities are determined by artefact
@@ -258,7 +258,7 @@ static const int table_ability_freq[ART_TYPE_MAX][OBJECT_XTRA_SIZE_POWER] =
 };
 
 /*used to keep frequencies for each ability*/
-static byte art_abil_freq[OBJECT_XTRA_SIZE_POWER];
+static GAME_LOCAL byte art_abil_freq[OBJECT_XTRA_SIZE_POWER];
 
 #define NUM_FAVORED_SLAY_PAIRS 4
 
@@ -309,26 +309,26 @@ static s16b *kinds;
 /*
  * Store the original artefact power ratings
  */
-static s32b *base_power;
+static GAME_LOCAL s32b *base_power;
 
 /*
  * Store the original base item levels
  */
-static byte *base_item_level;
+static GAME_LOCAL byte *base_item_level;
 
 /*
  * Store the original base item rarities
  */
-static byte *base_item_rarity;
+static GAME_LOCAL byte *base_item_rarity;
 
 /*
  * Store the original artefact rarities
  */
-static byte *base_art_rarity;
+static GAME_LOCAL byte *base_art_rarity;
 
 /* Store the current artefact k_idx */
 
-static s16b cur_art_k_idx;
+static GAME_LOCAL s16b cur_art_k_idx;
 
 
 /*
@@ -339,7 +339,7 @@ static s16b cur_art_k_idx;
  */
 static char *make_word(void)
 {
-	static char word_buf[90];
+	static GAME_LOCAL char word_buf[90];
 	int r, totalfreq;
 	int tries, lnum, vow;
 	int c_prev, c_cur, c_next;
@@ -1454,7 +1454,7 @@ static bool add_sustain(artefact_type *a_ptr)
 	int stat_selector, stat_counter, counter, stat_freq_total;
 	u32b sust_flag, stat_flag;
 
-	static byte art_sust_freq[A_MAX];
+	static GAME_LOCAL byte art_sust_freq[A_MAX];
 
 	/*find out the current frequency total*/
 	stat_freq_total = 0;
@@ -2899,9 +2899,6 @@ void build_randart_tables(void)
 	/* Initialize the monster power ratings */
 	(void)init_mon_power();
 
-	/*build the frequency tables*/
-	build_art_freq_table();
-
 }
 
 /*free the randart tables at the end of the game*/
@@ -2938,6 +2935,9 @@ errr do_randart(u32b randart_seed, bool full)
 		/* Store the original power ratings */
 		store_base_power();
 
+		/*build the frequency tables (afresh for each game)*/
+		build_art_freq_table();
+
 		/*adjust the randart frequencies to enforce minimum values*/
 		adjust_art_freq_table();
 
@@ -71,28 +71,28 @@
 /*
  * Hack -- current savefile
  */
-static int data_fd = -1;
+static GAME_LOCAL int data_fd = -1;
 
 
 /*
  * Hack -- current block type
  */
-static u16b data_type;
+static GAME_LOCAL u16b data_type;
 
 /*
  * Hack -- current block size
  */
-static u16b data_size;
+static GAME_LOCAL u16b data_size;
 
 /*
  * Hack -- pointer to the data buffer
  */
-static byte *data_head;
+static GAME_LOCAL byte *data_head;
 
 /*
  * Hack -- pointer into the data buffer
  */
-static byte *data_next;
+static GAME_LOCAL byte *data_next;
 
 
 
@@ -370,24 +370,50 @@ static errr rd_savefile(void)
  * Some "local" parameters, used to help write savefiles
  */
 
-static FILE	*fff;		/* Current save "file" */
+static GAME_LOCAL byte	*sf_buf;	/* The savefile, built up in memory */
+static GAME_LOCAL u32b	sf_len;		/* Bytes in "sf_buf" so far */
+static GAME_LOCAL u32b	sf_max;		/* Room in "sf_buf" */
 
-static byte	xor_byte;	/* Simple encryption */
+static GAME_LOCAL byte	xor_byte;	/* Simple encryption */
 
-static u32b	v_stamp = 0L;	/* A simple "checksum" on the actual values */
-static u32b	x_stamp = 0L;	/* A simple "checksum" on the encoded bytes */
+static GAME_LOCAL u32b	v_stamp = 0L;	/* A simple "checksum" on the actual values */
+static GAME_LOCAL u32b	x_stamp = 0L;	/* A simple "checksum" on the encoded bytes */
 
 
 
+/*
+ * Make more room in "sf_buf"
+ */
+static void sf_grow(void)
+{
+	byte *old = sf_buf;
+
+	/* Twice the room */
+	sf_max = sf_max ? 2 * sf_max : 256 * 1024L;
+
+	/* Move the savefile so far */
+	C_MAKE(sf_buf, sf_max, byte);
+	if (sf_len) C_COPY(sf_buf, old, sf_len, byte);
+
+	FREE(old);
+}
+
+
 /*
  * These functions place information into a savefile a byte at a time
+ *
+ * The savefile is built up in memory and written out all at once when it
+ * is complete (see "save_player_aux()").
  */
 
 static void sf_put(byte v)
 {
+	/* Make room */
+	if (sf_len == sf_max) sf_grow();
+
 	/* Encode the value, write a character */
 	xor_byte ^= v;
-	(void)putc((int)xor_byte, fff);
+	sf_buf[sf_len++] = xor_byte;
 
 	/* Maintain the checksum info */
 	v_stamp += v;
@@ -653,13 +679,14 @@ static errr wr_randomizer(void)
 	wr_u32b(0L);
 	wr_u32b(0L);
 	
-	/* Place */
-	wr_u16b(Rand_place);
+	/* Current stream */
+	wr_u16b(Rand_stream);
 
-	/* State */
+	/* State of each stream (padded out to the old size) */
 	for (i = 0; i < RAND_DEG; i++)
 	{
-		wr_u32b(Rand_state[i]);
+		if (i < RAND_STREAMS * RAND_WORDS) wr_u32b(Rand_state[i / RAND_WORDS][i % RAND_WORDS]);
+		else                               wr_u32b(0L);
 	}
 
 	/* Success */
@@ -1356,9 +1383,6 @@ static bool wr_savefile(void)
 	wr_u32b(x_stamp);
 
 
-	/* Error in save */
-	if (ferror(fff) || (fflush(fff) == EOF)) return FALSE;
-
 	/* Successful save */
 	return TRUE;
 }
@@ -1367,7 +1391,8 @@ static bool wr_savefile(void)
 /*
  * Medium level player saver
  *
- * XXX XXX XXX Angband 2.8.0 will use "fd" instead of "fff" if possible
+ * The whole savefile is built in memory first, and then written with a
+ * single "fd_write()" and flushed to the disk before it is used.
  */
 static bool save_player_aux(cptr name)
 {
@@ -1378,58 +1403,47 @@ static bool save_player_aux(cptr name)
 	int mode = 0644;
 
 
-	/* No file yet */
-	fff = NULL;
-
-
-	/* File type is "SAVE" */
-	FILE_TYPE(FILE_TYPE_SAVE);
-
-
-	/* Grab permissions */
-	safe_setuid_grab();
-
-	/* Create the savefile */
-	fd = fd_make(name, mode);
+	/* Start with an empty savefile */
+	sf_len = 0;
 
-	/* Drop permissions */
-	safe_setuid_drop();
-
-	/* File is okay */
-	if (fd >= 0)
+	/* Build the savefile */
+	if (wr_savefile())
 	{
-		/* Close the "fd" */
-		fd_close(fd);
+		/* File type is "SAVE" */
+		FILE_TYPE(FILE_TYPE_SAVE);
 
 		/* Grab permissions */
 		safe_setuid_grab();
 
-		/* Open the savefile */
-		fff = my_fopen(name, "wb");
+		/* Create the savefile */
+		fd = fd_make(name, mode);
 
 		/* Drop permissions */
 		safe_setuid_drop();
 
-		/* Successful open */
-		if (fff)
+		/* File is okay */
+		if (fd >= 0)
 		{
-			/* Write the savefile */
-			if (wr_savefile()) ok = TRUE;
+			/* Write the savefile, and make sure it reaches the disk */
+			if (!fd_write(fd, (cptr)sf_buf, sf_len) && !fd_sync(fd)) ok = TRUE;
 
-			/* Attempt to close it */
-			if (my_fclose(fff)) ok = FALSE;
-		}
+			/* Close it */
+			fd_close(fd);
 
-		/* Grab permissions */
-		safe_setuid_grab();
+			/* Grab permissions */
+			safe_setuid_grab();
 
-		/* Remove "broken" files */
-		if (!ok) fd_kill(name);
+			/* Remove "broken" files */
+			if (!ok) fd_kill(name);
 
-		/* Drop permissions */
-		safe_setuid_drop();
+			/* Drop permissions */
+			safe_setuid_drop();
+		}
 	}
 
+	/* Free the savefile */
+	KILL(sf_buf);
+	sf_len = sf_max = 0;
 
 	/* Failure */
 	if (!ok) return (FALSE);
@@ -1457,6 +1471,13 @@ bool save_player(void)
 	{
 		return (FALSE);
 	}
+
+	/* Replays never write the savefile, but must play out as if they had */
+	if (arg_replay && savefile[0])
+	{
+		character_loaded = TRUE;
+		return (TRUE);
+	}
 	
 	/* New savefile */
 	my_strcpy(safe, savefile, sizeof(safe));
@@ -1495,6 +1516,13 @@ bool save_player(void)
 		/* Grab permissions */
 		safe_setuid_grab();
 
+#ifdef SET_UID
+
+		/* Activate new savefile (replacing the old one in a single step) */
+		fd_move(safe, savefile);
+
+#else /* SET_UID */
+
 		/* Remove it */
 		fd_kill(temp);
 
@@ -1507,6 +1535,8 @@ bool save_player(void)
 		/* Remove preserved savefile */
 		fd_kill(temp);
 
+#endif /* SET_UID */
+
 		/* Drop permissions */
 		safe_setuid_drop();
 
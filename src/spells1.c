@@ -13,7 +13,7 @@
 /*
  * Mega-Hack -- count number of monsters killed out of sight
  */
-static int death_count;
+static GAME_LOCAL int death_count;
 
 
 /*
@@ -1552,9 +1552,9 @@ bool apply_disenchant(int mode)
 /*
  * Mega-Hack -- track "affected" monsters (see "project()" comments)
  */
-static int project_m_n;
-static int project_m_x;
-static int project_m_y;
+static GAME_LOCAL int project_m_n;
+static GAME_LOCAL int project_m_x;
+static GAME_LOCAL int project_m_y;
 
 
 /*
@@ -4354,7 +4354,7 @@ void song_of_freedom(int score)
                 if (skill_check(PLAYER, score, difficulty, NULL) > 0)
                 {
                     /* Remove the trap */
-                    cave_feat[y][x] = FEAT_FLOOR;
+                    cave_set_feat(y, x, FEAT_FLOOR);
                 }
             }
             
@@ -4365,7 +4365,7 @@ void song_of_freedom(int score)
                 if (skill_check(PLAYER, score, difficulty, NULL) > 0)
                 {
                     /* Remove the trap */
-                    cave_feat[y][x] = FEAT_FLOOR;
+                    cave_set_feat(y, x, FEAT_FLOOR);
                     
                     if (cave_info[y][x] & (CAVE_SEEN))
                     {
@@ -4405,7 +4405,7 @@ void song_of_freedom(int score)
                     
                     if (new_feat <= FEAT_DOOR_HEAD + 0x08) new_feat = FEAT_DOOR_HEAD;
                     
-                    cave_feat[y][x] = new_feat;
+                    cave_set_feat(y, x, new_feat);
                 }
             }
             
@@ -4420,7 +4420,7 @@ void song_of_freedom(int score)
                     
                     if (new_feat < FEAT_DOOR_HEAD) new_feat = FEAT_DOOR_HEAD;
                     
-                    cave_feat[y][x] = new_feat;
+                    cave_set_feat(y, x, new_feat);
                 }
             }
             
@@ -30,7 +30,7 @@ struct tval_insc_desc
  * applicable tvals there shouldn't be a problem.
  */
 
-byte squelch_level[SQUELCH_BYTES];
+GAME_LOCAL byte squelch_level[SQUELCH_BYTES];
 
 #define LINES_PER_COLUMN   19
 
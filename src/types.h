@@ -62,6 +62,11 @@ typedef byte byte_wid[MAX_DUNGEON_WID];
  */
 typedef s16b s16b_wid[MAX_DUNGEON_WID];
 
+/*
+ * A row of MAX_DUNGEON_WID bits, packed into words
+ */
+typedef u32b bits_wid[MAP_WORDS];
+
 
 
 /**** Available Structs ****/
@@ -93,6 +98,7 @@ typedef struct names_type names_type;
 typedef struct flavor_type flavor_type;
 typedef struct editing_buffer editing_buffer;
 typedef struct autoinscription autoinscription;
+typedef struct flow_class_type flow_class_type;
 
 /**** Available structs ****/
 
@@ -613,6 +619,8 @@ struct monster_type
 	s16b wandering_idx;	/* Where the monster is wandering while unwary (if anywhere) */
 	byte wandering_dist;/* The distance to the destination */
 
+	s16b flow;			/* Which flow it follows to the player while alert */  /* Not saved */
+
 	byte min_range;		/* What is the closest we want to be? */  /* Not saved */
 	byte best_range;	/* How close do we want to be? */  /* Not saved */
 
@@ -644,7 +652,7 @@ struct alloc_entry
 	byte prob2;		/* Probability, pass 2 */
 	byte prob3;		/* Probability, pass 3 */
 
-	u16b total;		/* Unused for now */
+	s32b total;		/* Sum of "prob3" up to and including this entry */
 };
 
 
@@ -1137,6 +1145,24 @@ struct high_score
 };
 
 
+/*
+ * A movement class for alert monsters.
+ *
+ * Monsters of the same class would get identical flows towards the player,
+ * so they all share the one flow (with the same index as the class).
+ */
+struct flow_class_type
+{
+	u32b flags;			/* Movement flags (RF2_MOVE_MASK) */
+	s16b per;			/* Perception (for unlocking doors) */
+	s16b wil;			/* Will (for breaking glyphs) */
+	s16b str;			/* Strength (for bashing doors) */
+
+	u32b m_handle;		/* The monster the flow was last built for (see "mon_handle()") */
+	s32b turn;			/* Game turn when the class was last used (0 if unused) */
+};
+
+
 // A type to contain information on a combat roll for printing
 
 typedef struct combat_roll combat_roll;
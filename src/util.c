@@ -823,6 +823,27 @@ errr fd_write(int fd, cptr buf, size_t n)
 }
 
 
+/*
+ * Hack -- attempt to make sure everything written to a file descriptor
+ * has reached the disk
+ */
+errr fd_sync(int fd)
+{
+	/* Verify the fd */
+	if (fd < 0) return (-1);
+
+#ifdef SET_UID
+
+	/* Flush it */
+	if (fsync(fd)) return (1);
+
+#endif /* SET_UID */
+
+	/* Success */
+	return (0);
+}
+
+
 /*
  * Hack -- attempt to close a file descriptor
  */
@@ -1670,7 +1691,7 @@ void flush_fail(void)
  *
  * Do not match any macros until "ascii 30" is found.
  */
-static bool parse_macro = FALSE;
+static GAME_LOCAL bool parse_macro = FALSE;
 
 
 /*
@@ -1678,7 +1699,7 @@ static bool parse_macro = FALSE;
  *
  * Strip all keypresses until a low ascii value is found.
  */
-static bool parse_under = FALSE;
+static GAME_LOCAL bool parse_under = FALSE;
 
 
 
@@ -1846,7 +1867,7 @@ static char inkey_aux(void)
  * trigger any macros, and cannot be bypassed by the automaton.  It is used
  * in Angband to handle "keymaps".
  */
-static cptr inkey_next = NULL;
+static GAME_LOCAL cptr inkey_next = NULL;
 
 
 /*
@@ -1855,7 +1876,493 @@ static cptr inkey_next = NULL;
  * This special function hook allows the "automaton" (see elsewhere) to take
  * control of the "inkey()" function, and substitute in fake keypresses.
  */
-char (*inkey_hack)(int flush_first) = NULL;
+GAME_LOCAL char (*inkey_hack)(int flush_first) = NULL;
+
+
+/*
+ * Keypress logs
+ *
+ * A keypress log holds everything needed to play a game again exactly as
+ * it was played: a header line saying how the game began, followed by
+ * every key that "inkey()" returned (including the zeros for "no key ready"),
+ * one byte each.  Keys from keymaps are not logged, since they follow from
+ * the keys that triggered them.
+ *
+ * The automaton also sets the player's target directly, rather than with
+ * keys, so whenever it does so while choosing a key, the new target is logged
+ * before the key as KEYLOG_ESCAPE, 't' and four two byte values.
+ * A key that happens to be KEYLOG_ESCAPE is logged as KEYLOG_ESCAPE, 'k'.
+ *
+ * A game that began from a savefile also needs that savefile, so a copy of
+ * it is made next to the log (with ".sav" on the end) when recording starts.
+ */
+static GAME_LOCAL FILE *keylog_fff = NULL;
+static GAME_LOCAL FILE *replay_fff = NULL;
+
+/* The target from before the automaton chose the key being logged */
+static GAME_LOCAL s16b keylog_target[4];
+
+
+/*
+ * Hack -- the target fields of the player, in the order they are logged
+ */
+static s16b *keylog_target_field(int i)
+{
+	switch (i)
+	{
+		case 0: return (&p_ptr->target_set);
+		case 1: return (&p_ptr->target_who);
+		case 2: return (&p_ptr->target_row);
+		default: return (&p_ptr->target_col);
+	}
+}
+
+
+/*
+ * Start recording the keys of the current game into the file 'name'.
+ *
+ * 'seed' is the seed of the RNG, if the game is a new one.
+ */
+void keylog_record(cptr name, u32b seed)
+{
+	char buf[1024];
+	FILE *fff;
+
+	/* Keep a copy of the savefile the game came from */
+	if (character_loaded)
+	{
+		FILE *src = my_fopen(savefile, "rb");
+		size_t n;
+
+		strnfmt(buf, sizeof(buf), "%s.sav", name);
+		fff = my_fopen(buf, "wb");
+
+		if (!src || !fff) quit_fmt("Cannot copy the savefile to '%s'.", buf);
+
+		while ((n = fread(buf, 1, sizeof(buf), src)) > 0) fwrite(buf, 1, n, fff);
+
+		my_fclose(src);
+		my_fclose(fff);
+	}
+
+	keylog_fff = my_fopen(name, "wb");
+
+	if (!keylog_fff) quit_fmt("Cannot record keys to '%s'.", name);
+
+	fprintf(keylog_fff, "%s batch=%d seed=%lu loaded=%d\n", KEYLOG_HEADER,
+	        arg_batch ? 1 : 0, (unsigned long)seed, character_loaded ? 1 : 0);
+
+}
+
+
+/*
+ * Open the file 'name' to replay the keys of a game recorded in it.
+ *
+ * Reports whether the game was a batch game, what its seed was, and whether
+ * it came from a savefile (see "keylog_record()").
+ */
+errr keylog_replay(cptr name, bool *batch, u32b *seed, bool *loaded)
+{
+	char buf[80];
+	int b, l;
+	unsigned long s;
+
+	replay_fff = my_fopen(name, "rb");
+
+	if (!replay_fff) return (-1);
+
+	/* Read the header */
+	if (!fgets(buf, sizeof(buf), replay_fff) ||
+	    !prefix(buf, KEYLOG_HEADER) ||
+	    (sscanf(buf + strlen(KEYLOG_HEADER), " batch=%d seed=%lu loaded=%d", &b, &s, &l) != 3))
+	{
+		my_fclose(replay_fff);
+		replay_fff = NULL;
+		return (-1);
+	}
+
+	(*batch) = (b != 0);
+	(*seed) = (u32b)s;
+	(*loaded) = (l != 0);
+
+	return (0);
+}
+
+
+/*
+ * Remember the target, so that any change made to it can be logged
+ */
+static void keylog_mark(void)
+{
+	int i;
+
+	for (i = 0; i < 4; i++) keylog_target[i] = *keylog_target_field(i);
+}
+
+
+/*
+ * Log a key, after the target if it has changed since "keylog_mark()"
+ */
+static void keylog_put(char ch)
+{
+	int i;
+
+	for (i = 0; i < 4; i++)
+	{
+		if (*keylog_target_field(i) != keylog_target[i]) break;
+	}
+
+	/* The target has changed */
+	if (i < 4)
+	{
+		(void)putc(KEYLOG_ESCAPE, keylog_fff);
+		(void)putc('t', keylog_fff);
+
+		for (i = 0; i < 4; i++)
+		{
+			keylog_target[i] = *keylog_target_field(i);
+
+			(void)putc(keylog_target[i] & 0xFF, keylog_fff);
+			(void)putc((keylog_target[i] >> 8) & 0xFF, keylog_fff);
+		}
+	}
+
+	/* The key itself */
+	if ((byte)ch == KEYLOG_ESCAPE)
+	{
+		(void)putc(KEYLOG_ESCAPE, keylog_fff);
+		(void)putc('k', keylog_fff);
+	}
+	else
+	{
+		(void)putc((byte)ch, keylog_fff);
+	}
+}
+
+
+/*
+ * Get the next key from a log being replayed, setting the target on the way
+ * if the log says so.  Returns EOF when the log runs out.
+ */
+static int keylog_get(void)
+{
+	int c, i;
+
+	while ((c = getc(replay_fff)) == KEYLOG_ESCAPE)
+	{
+		c = getc(replay_fff);
+
+		/* A key that looks like an escape */
+		if (c == 'k') return (KEYLOG_ESCAPE);
+
+		/* Anything else is the end of the log */
+		if (c != 't') return (EOF);
+
+		for (i = 0; i < 4; i++)
+		{
+			int lo = getc(replay_fff);
+			int hi = getc(replay_fff);
+
+			if (hi == EOF) return (EOF);
+
+			*keylog_target_field(i) = (s16b)(lo | (hi << 8));
+		}
+	}
+
+	return (c);
+}
+
+
+/*
+ * Stop recording or replaying keys.
+ */
+void keylog_close(void)
+{
+	if (keylog_fff) my_fclose(keylog_fff);
+	if (replay_fff) my_fclose(replay_fff);
+
+	keylog_fff = NULL;
+	replay_fff = NULL;
+}
+
+
+/*
+ * Mix a value into a state hash (FNV-1a)
+ */
+static void state_hash_aux(u32b *h, s32b v)
+{
+	int i;
+
+	for (i = 0; i < 4; i++)
+	{
+		(*h) ^= (u32b)((v >> (i * 8)) & 0xFF);
+		(*h) = ((*h) * 16777619UL) & 0xFFFFFFFFUL;
+	}
+}
+
+
+/*
+ * Hash the parts of the game state that show how a game went: the player,
+ * the map, the monsters, the objects and the time.
+ *
+ * Two games with the same hash almost certainly played out the same way,
+ * which makes this a quick check that a replay (or an optimisation) didn't
+ * change anything.
+ */
+u32b state_hash(void)
+{
+	u32b h = 2166136261UL;
+	int i, y, x;
+
+	state_hash_aux(&h, turn);
+	state_hash_aux(&h, playerturn);
+
+	/* The player */
+	state_hash_aux(&h, p_ptr->depth);
+	state_hash_aux(&h, p_ptr->max_depth);
+	state_hash_aux(&h, p_ptr->py);
+	state_hash_aux(&h, p_ptr->px);
+	state_hash_aux(&h, p_ptr->chp);
+	state_hash_aux(&h, p_ptr->csp);
+	state_hash_aux(&h, p_ptr->exp);
+	state_hash_aux(&h, p_ptr->energy);
+	for (i = 0; i < A_MAX; i++) state_hash_aux(&h, p_ptr->stat_base[i]);
+	for (i = 0; i < A_MAX; i++) state_hash_aux(&h, p_ptr->stat_drain[i]);
+	for (i = 0; i < S_MAX; i++) state_hash_aux(&h, p_ptr->skill_base[i]);
+
+	/* The inventory */
+	for (i = 0; i < INVEN_TOTAL; i++)
+	{
+		state_hash_aux(&h, inventory[i].k_idx);
+		state_hash_aux(&h, inventory[i].number);
+		state_hash_aux(&h, inventory[i].pval);
+	}
+
+	/* The map */
+	for (y = 0; y < p_ptr->cur_map_hgt; y++)
+	{
+		for (x = 0; x < p_ptr->cur_map_wid; x++)
+		{
+			state_hash_aux(&h, cave_feat[y][x]);
+			state_hash_aux(&h, cave_info[y][x]);
+		}
+	}
+
+	/* The monsters */
+	for (i = 1; i < mon_max; i++)
+	{
+		monster_type *m_ptr = &mon_list[i];
+
+		state_hash_aux(&h, m_ptr->r_idx);
+		state_hash_aux(&h, m_ptr->fy);
+		state_hash_aux(&h, m_ptr->fx);
+		state_hash_aux(&h, m_ptr->hp);
+		state_hash_aux(&h, m_ptr->alertness);
+	}
+
+	/* The objects */
+	for (i = 1; i < o_max; i++)
+	{
+		object_type *o_ptr = &o_list[i];
+
+		state_hash_aux(&h, o_ptr->k_idx);
+		state_hash_aux(&h, o_ptr->iy);
+		state_hash_aux(&h, o_ptr->ix);
+		state_hash_aux(&h, o_ptr->number);
+	}
+
+	return (h);
+}
+
+
+/*
+ * The current time, in microseconds from some arbitrary point
+ * (used by the profiler, and to time level generation)
+ */
+double profile_clock(void)
+{
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0);
+#else
+	return (clock() * (1000000.0 / CLOCKS_PER_SEC));
+#endif
+}
+
+
+#ifdef ALLOW_PROFILE
+
+/*
+ * Profiler
+ *
+ * Each of the parts of the game in "profile_name" has a timer which is
+ * started and stopped around it with PROFILE_START() and PROFILE_STOP(),
+ * counting the calls and adding up the time they took.  Parts that run
+ * inside other parts are counted in both, and a part that runs inside
+ * itself is only timed on the outside.  The player's part includes the time
+ * spent waiting for keys (or for the automaton to choose them).
+ */
+static cptr profile_name[PROF_MAX] =
+{
+	"process_player",
+	"process_monsters",
+	"process_monster",
+	"update_flow",
+	"update_view",
+	"update_monsters",
+	"process_world",
+	"redraw_stuff",
+	"window_stuff",
+	"generate_cave"
+};
+
+/*
+ * The events counted, and the caches whose hit rates they give
+ */
+static cptr profile_count_name[PROF_COUNT_MAX] =
+{
+	"los queries",
+	"los cache hits",
+	"field queries",
+	"field hits",
+	"levels made",
+	"level attempts",
+	"game turns",
+	"idle turns skipped"
+};
+
+static GAME_LOCAL long profile_counts[PROF_COUNT_MAX];
+
+static GAME_LOCAL double profile_total[PROF_MAX];
+static GAME_LOCAL double profile_since[PROF_MAX];
+static GAME_LOCAL long profile_calls[PROF_MAX];
+static GAME_LOCAL int profile_depth[PROF_MAX];
+
+/* When the first timer was started, and the turn it was started on */
+static GAME_LOCAL double profile_begin = -1.0;
+static GAME_LOCAL s32b profile_begin_turn;
+
+
+/*
+ * Start the timer for the part of the game 'n'
+ */
+void profile_start(int n)
+{
+	profile_calls[n]++;
+
+	/* Already running */
+	if (profile_depth[n]++) return;
+
+	profile_since[n] = profile_clock();
+
+	/* The first timer starts the clock for the whole report */
+	if (profile_begin < 0.0)
+	{
+		profile_begin = profile_since[n];
+		profile_begin_turn = turn;
+	}
+}
+
+
+/*
+ * Stop the timer for the part of the game 'n'
+ */
+void profile_stop(int n)
+{
+	/* Still running on the outside */
+	if (--profile_depth[n]) return;
+
+	profile_total[n] += profile_clock() - profile_since[n];
+}
+
+
+/*
+ * Count one of the events 'n'
+ */
+void profile_count(int n)
+{
+	profile_counts[n]++;
+}
+
+
+/*
+ * Count 'x' of the events 'n'
+ */
+void profile_add(int n, long x)
+{
+	profile_counts[n] += x;
+}
+
+
+/*
+ * Report a count of hits against a count of queries
+ */
+static void profile_report_rate(FILE *fff, cptr name, long queries, long hits)
+{
+	fprintf(fff, "%-18s %10ld queries %10ld hits %6.1f%%\n", name, queries, hits,
+	        queries ? 100.0 * hits / queries : 0.0);
+}
+
+
+/*
+ * Write a report of the times for each part of the game to 'fff'.
+ * Does nothing if no timer has ever been started.
+ */
+void profile_report(FILE *fff)
+{
+	double elapsed;
+	int n;
+
+	if (profile_begin < 0.0) return;
+
+	elapsed = profile_clock() - profile_begin;
+	if (elapsed <= 0.0) elapsed = 1.0;
+
+	fprintf(fff, "Profile of %ld game turns over %.3f seconds\n\n",
+	        (long)(turn - profile_begin_turn), elapsed / 1000000.0);
+	fprintf(fff, "%-18s %10s %12s %10s %7s\n", "part", "calls", "total ms", "us/call", "time");
+
+	for (n = 0; n < PROF_MAX; n++)
+	{
+		fprintf(fff, "%-18s %10ld %12.1f %10.2f %6.1f%%\n", profile_name[n],
+		        profile_calls[n], profile_total[n] / 1000.0,
+		        profile_calls[n] ? profile_total[n] / profile_calls[n] : 0.0,
+		        100.0 * profile_total[n] / elapsed);
+	}
+
+	fprintf(fff, "\n");
+
+	for (n = 0; n < PROF_COUNT_MAX; n++)
+	{
+		fprintf(fff, "%-18s %10ld\n", profile_count_name[n], profile_counts[n]);
+	}
+
+	fprintf(fff, "\n");
+
+	profile_report_rate(fff, "los cache", profile_counts[PROF_LOS_QUERIES], profile_counts[PROF_LOS_HITS]);
+	profile_report_rate(fff, "player field", profile_counts[PROF_FIELD_QUERIES], profile_counts[PROF_FIELD_HITS]);
+}
+
+#endif /* ALLOW_PROFILE */
+
+
+/*
+ * Hack -- the end of "inkey()", which logs each key when recording
+ */
+static char inkey_done(char ch)
+{
+	/* Cancel the various "global parameters" */
+	inkey_base = inkey_xtra = inkey_flag = inkey_scan = FALSE;
+
+	/* Record the key */
+	if (keylog_fff) keylog_put(ch);
+
+	/* Accept result */
+	return (ch);
+}
 
 
 
@@ -1920,6 +2427,9 @@ char (*inkey_hack)(int flush_first) = NULL;
  *
  * Mega-Hack -- Note the use of "inkey_hack" to allow the "automaton" to steal
  * control of the keyboard from the user.
+ *
+ * Hack -- When a keypress log is being replayed, every key comes from it
+ * (see "keylog_replay()"), and the game ends when it runs out.
  */
 char inkey(void)
 {
@@ -1949,14 +2459,28 @@ char inkey(void)
 	/* Forget pointer */
 	inkey_next = NULL;
 
-	/* Mega-Hack -- Use the special hook for the automaton */
-	if (inkey_hack && ((ch = (*inkey_hack)(inkey_xtra)) != 0))
+	/* Hack -- Replay a keypress log */
+	if (replay_fff)
 	{
+		int c = keylog_get();
+
+		/* The game ends with the log */
+		if (c == EOF) automaton_batch_end("end_of_log");
+
 		/* Cancel the various "global parameters" */
 		inkey_base = inkey_xtra = inkey_flag = inkey_scan = FALSE;
-    
+
 		/* Accept result */
-		return (ch);
+		return ((char)c);
+	}
+
+	/* Note the target, which the automaton may change */
+	if (keylog_fff) keylog_mark();
+
+	/* Mega-Hack -- Use the special hook for the automaton */
+	if (inkey_hack && ((ch = (*inkey_hack)(inkey_xtra)) != 0))
+	{
+		return (inkey_done(ch));
 	}
 
 	/* Hack -- handle delayed "flush()" */
@@ -2134,12 +2658,8 @@ char inkey(void)
 	Term_set_cursor(cursor_state);
 
 
-	/* Cancel the various "global parameters" */
-	inkey_base = inkey_xtra = inkey_flag = inkey_scan = FALSE;
-
-
 	/* Return the keypress */
-	return (ch);
+	return (inkey_done(ch));
 }
 
 
@@ -2212,13 +2732,19 @@ void sound(int val)
 /*
  * The number of quarks (first quark is NULL)
  */
-static s16b quark__num = 1;
+static GAME_LOCAL s16b quark__num = 1;
 
 
 /*
  * The array[QUARK_MAX] of pointers to the quarks
  */
-static cptr *quark__str;
+static GAME_LOCAL cptr *quark__str;
+
+
+/*
+ * Finds the quarks by their strings
+ */
+static GAME_LOCAL index_table quark__index;
 
 
 /*
@@ -2226,10 +2752,12 @@ static cptr *quark__str;
  */
 s16b quark_add(cptr str)
 {
+	u32b hash = hash_string(str);
+	u32b probe = 0;
 	int i;
 
 	/* Look for an existing quark */
-	for (i = 1; i < quark__num; i++)
+	while ((i = index_table_find(&quark__index, hash, &probe)) >= 0)
 	{
 		/* Check for equality */
 		if (streq(quark__str[i], str)) return (i);
@@ -2243,6 +2771,7 @@ s16b quark_add(cptr str)
 
 	/* Add a new quark */
 	quark__str[i] = string_make(str);
+	index_table_add(&quark__index, hash, i);
 
 	/* Return the index */
 	return (i);
@@ -2275,6 +2804,10 @@ errr quarks_init(void)
 	/* Quark variables */
 	C_MAKE(quark__str, QUARK_MAX, cptr);
 
+	/* Quark index */
+	quark__index.size = index_table_size(QUARK_MAX);
+	C_MAKE(quark__index.slot, quark__index.size, u16b);
+
 	/* Success */
 	return (0);
 }
@@ -2296,6 +2829,9 @@ errr quarks_free(void)
 	/* Free the list of "quarks" */
 	FREE((void*)quark__str);
 
+	/* Free the quark index */
+	FREE(quark__index.slot);
+
 	/* Success */
 	return (0);
 }
@@ -2346,42 +2882,42 @@ errr quarks_free(void)
 /*
  * The next "free" index to use
  */
-static u16b message__next;
+static GAME_LOCAL u16b message__next;
 
 /*
  * The index of the oldest message (none yet)
  */
-static u16b message__last;
+static GAME_LOCAL u16b message__last;
 
 /*
  * The next "free" offset
  */
-static u16b message__head;
+static GAME_LOCAL u16b message__head;
 
 /*
  * The offset to the oldest used char (none yet)
  */
-static u16b message__tail;
+static GAME_LOCAL u16b message__tail;
 
 /*
  * The array[MESSAGE_MAX] of offsets, by index
  */
-static u16b *message__ptr;
+static GAME_LOCAL u16b *message__ptr;
 
 /*
  * The array[MESSAGE_BUF] of chars, by offset
  */
-static char *message__buf;
+static GAME_LOCAL char *message__buf;
 
 /*
  * The array[MESSAGE_MAX] of u16b for the types of messages
  */
-static u16b *message__type;
+static GAME_LOCAL u16b *message__type;
 
 /*
  * The array[MESSAGE_MAX] of u16b for the count of messages
  */
-static u16b *message__count;
+static GAME_LOCAL u16b *message__count;
 
 
 /*
@@ -2458,7 +2994,7 @@ int interactive_input(bool look_ahead)
  */
 cptr message_str(s16b age)
 {
-	static char buf[1024];
+	static GAME_LOCAL char buf[1024];
 	s16b x;
 	u16b o;
 	cptr s;
@@ -2887,7 +3423,7 @@ static void msg_flush(int x)
 }
 
 
-static int message_column = 0;
+static GAME_LOCAL int message_column = 0;
 
 
 /*
@@ -3148,7 +3684,7 @@ void message_flush(void)
 /*
  * Hack -- prevent "accidents" in "screen_save()" or "screen_load()"
  */
-static int screen_depth = 0;
+static GAME_LOCAL int screen_depth = 0;
 
 
 /*
@@ -3367,7 +3903,7 @@ void text_out_to_screen(byte a, cptr str)
 void text_out_to_file(byte a, cptr str)
 {
 	/* Current position on the line */
-	static int pos = 0;
+	static GAME_LOCAL int pos = 0;
 
 	/* Wrap width */
 	int wrap = (text_out_wrap ? text_out_wrap : 75);
@@ -4064,7 +4600,7 @@ void pause_line(int row)
 /*
  * Hack -- special buffer to hold the action of the current keymap
  */
-static char request_command_buffer[256];
+static GAME_LOCAL char request_command_buffer[256];
 
 
 /*
@@ -4498,13 +5034,13 @@ static bool insert_str(char *buf, cptr target, cptr insert)
 #define REPEAT_MAX 20
 
 /* Number of chars saved */
-static int repeat__cnt = 0;
+static GAME_LOCAL int repeat__cnt = 0;
 
 /* Current index */
-static int repeat__idx = 0;
+static GAME_LOCAL int repeat__idx = 0;
 
 /* Saved "stuff" */
-static int repeat__key[REPEAT_MAX];
+static GAME_LOCAL int repeat__key[REPEAT_MAX];
 
 
 /*
@@ -5135,7 +5671,7 @@ int editing_buffer_put_str(editing_buffer *eb_ptr, const char *str, int n)
  */
 cptr get_ext_color_name(byte ext_color)
 {
-  	static char buf[25];
+  	static GAME_LOCAL char buf[25];
 
   	if (GET_SHADE(ext_color) > 0)
 	{
@@ -5261,7 +5797,7 @@ cptr attr_to_text(byte a)
 
   if (GET_SHADE(a) > 0)
   {
-    static char buf[25];
+    static GAME_LOCAL char buf[25];
 
     strnfmt(buf, sizeof(buf), "%s%d", base, GET_SHADE(a));
 
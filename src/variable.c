@@ -33,18 +33,18 @@ byte version_extra = VERSION_EXTRA;
 /*
  * Savefile version
  */
-byte sf_major;			/* Savefile's "version_major" */
-byte sf_minor;			/* Savefile's "version_minor" */
-byte sf_patch;			/* Savefile's "version_patch" */
-byte sf_extra;			/* Savefile's "version_extra" */
+GAME_LOCAL byte sf_major;			/* Savefile's "version_major" */
+GAME_LOCAL byte sf_minor;			/* Savefile's "version_minor" */
+GAME_LOCAL byte sf_patch;			/* Savefile's "version_patch" */
+GAME_LOCAL byte sf_extra;			/* Savefile's "version_extra" */
 
 /*
  * Savefile information
  */
-u32b sf_xtra;			/* Operating system info */
-u32b sf_when;			/* Time when savefile created */
-u16b sf_lives;			/* Number of past "lives" with this file */
-u16b sf_saves;			/* Number of "saves" during this life */
+GAME_LOCAL u32b sf_xtra;			/* Operating system info */
+GAME_LOCAL u32b sf_when;			/* Time when savefile created */
+GAME_LOCAL u16b sf_lives;			/* Number of past "lives" with this file */
+GAME_LOCAL u16b sf_saves;			/* Number of "saves" during this life */
 
 /*
  * Run-time arguments
@@ -55,80 +55,93 @@ bool arg_sound;				/* Command arg -- Request special sounds */
 bool arg_graphics;			/* Command arg -- Request graphics mode */
 bool arg_force_original;	/* Command arg -- Request original keyset */
 bool arg_force_roguelike;	/* Command arg -- Request roguelike keyset */
+bool arg_batch;				/* Command arg -- Play a batch game with the automaton */
+u32b arg_batch_seed;		/* Command arg -- Seed for the batch game */
+s32b arg_batch_turns = BATCH_TURN_LIMIT;	/* Command arg -- Turn limit for the batch game */
+int arg_gen_levels;			/* Command arg -- Levels to make at each depth for a benchmark */
+cptr arg_keylog;			/* Command arg -- Record the keys of the game to this file */
+cptr arg_replay;			/* Command arg -- Replay the keys of a game from this file */
 
 /*
  * Various things
  */
 
-bool character_generated;	/* The character exists */
-bool character_dungeon;		/* The character has a dungeon */
-bool character_loaded;		/* The character was loaded from a savefile and is living */
-bool character_loaded_dead;		/* The character was loaded from a savefile while dead */
-bool character_saved;		/* The character was just saved to a savefile */
+GAME_LOCAL bool character_generated;	/* The character exists */
+GAME_LOCAL bool character_dungeon;		/* The character has a dungeon */
+GAME_LOCAL bool character_loaded;		/* The character was loaded from a savefile and is living */
+GAME_LOCAL bool character_loaded_dead;		/* The character was loaded from a savefile while dead */
+GAME_LOCAL bool character_saved;		/* The character was just saved to a savefile */
 
-s16b character_icky;		/* Depth of the game in special mode */
-s16b character_xtra;		/* Depth of the game in startup mode */
+GAME_LOCAL s16b character_icky;		/* Depth of the game in special mode */
+GAME_LOCAL s16b character_xtra;		/* Depth of the game in startup mode */
 
-u32b seed_randart;		/* Hack -- consistent random artefacts */
+GAME_LOCAL u32b seed_randart;		/* Hack -- consistent random artefacts */
 
-u32b seed_flavor;		/* Hack -- consistent object colors */
+GAME_LOCAL u32b seed_flavor;		/* Hack -- consistent object colors */
 
-s16b num_repro;			/* Current reproducer count */
-s16b object_level;		/* Current object creation level */
-s16b monster_level;		/* Current monster creation level */
+GAME_LOCAL s16b num_repro;			/* Current reproducer count */
+GAME_LOCAL s16b object_level;		/* Current object creation level */
+GAME_LOCAL s16b monster_level;		/* Current monster creation level */
 
-char summon_kin_type;		/* Hack -- See summon_specific() */
+GAME_LOCAL char summon_kin_type;		/* Hack -- See summon_specific() */
 
-s32b turn;				/* Current game turn */
-s32b playerturn;		/* Current player turn */
+GAME_LOCAL s32b turn;				/* Current game turn */
+GAME_LOCAL s32b playerturn;		/* Current player turn */
 
-bool do_feeling;			/* Hack -- Level feeling counter */
+GAME_LOCAL bool do_feeling;			/* Hack -- Level feeling counter */
 
 bool use_sound;			/* The "sound" mode is enabled */
 int use_graphics;		/* The "graphics" mode is enabled */
 bool use_bigtile = FALSE;
 
-s16b image_count;  		/* Grids until next random image    */
+GAME_LOCAL s16b image_count;  		/* Grids until next random image    */
                   		/* Optimizes the hallucination code */
 
 s16b signal_count;		/* Hack -- Count interrupts */
 
-bool msg_flag;			/* Player has pending message */
+GAME_LOCAL bool msg_flag;			/* Player has pending message */
 
-bool inkey_base;		/* See the "inkey()" function */
-bool inkey_xtra;		/* See the "inkey()" function */
-bool inkey_scan;		/* See the "inkey()" function */
-bool inkey_flag;		/* See the "inkey()" function */
-bool hide_cursor;		/* See the "inkey()" function */
+GAME_LOCAL bool inkey_base;		/* See the "inkey()" function */
+GAME_LOCAL bool inkey_xtra;		/* See the "inkey()" function */
+GAME_LOCAL bool inkey_scan;		/* See the "inkey()" function */
+GAME_LOCAL bool inkey_flag;		/* See the "inkey()" function */
+GAME_LOCAL bool hide_cursor;		/* See the "inkey()" function */
 
-byte object_generation_mode;/* Hack -- use different depth check, prevent embedded chests */
+GAME_LOCAL byte object_generation_mode;/* Hack -- use different depth check, prevent embedded chests */
 
-bool shimmer_monsters;	/* Hack -- optimize multi-hued monsters */
-bool shimmer_objects;	/* Hack -- optimize multi-hued objects */
-bool repair_mflag_show;	/* Hack -- repair monster flags (show) */
-bool repair_mflag_mark;	/* Hack -- repair monster flags (mark) */
+GAME_LOCAL bool shimmer_monsters;	/* Hack -- optimize multi-hued monsters */
+GAME_LOCAL bool shimmer_objects;	/* Hack -- optimize multi-hued objects */
+GAME_LOCAL bool repair_mflag_show;	/* Hack -- repair monster flags (show) */
+GAME_LOCAL bool repair_mflag_mark;	/* Hack -- repair monster flags (mark) */
 
-s16b o_max = 1;			/* Number of allocated objects */
-s16b o_cnt = 0;			/* Number of live objects */
+GAME_LOCAL s16b o_max = 1;			/* Number of allocated objects */
+GAME_LOCAL s16b o_cnt = 0;			/* Number of live objects */
+GAME_LOCAL s16b *o_free;			/* Indexes of the holes in "o_list" */
+GAME_LOCAL s16b o_free_num = 0;	/* Number of entries in "o_free" */
 
-s16b mon_max = 1;	/* Number of allocated monsters */
-s16b mon_cnt = 0;	/* Number of live monsters */
+GAME_LOCAL s16b mon_max = 1;	/* Number of allocated monsters */
+GAME_LOCAL s16b mon_cnt = 0;	/* Number of live monsters */
+GAME_LOCAL s16b *mon_live;		/* Indexes of the live monsters, in order */
+GAME_LOCAL s16b mon_live_num = 0;	/* Number of entries in "mon_live" */
+GAME_LOCAL s16b *mon_free;		/* Indexes of the holes in "mon_list" */
+GAME_LOCAL s16b mon_free_num = 0;	/* Number of entries in "mon_free" */
+GAME_LOCAL u16b *mon_gen;		/* Generations of the entries in "mon_list" */
 
 
 /*
  *  Most of the extra Sil variables...
  */
 
-bool waiting_for_command = FALSE; // whether we are currently waiting for a command
+GAME_LOCAL bool waiting_for_command = FALSE; // whether we are currently waiting for a command
 
-bool skill_gain_in_progress = FALSE; // whether we are currently in the skill-gain screen
+GAME_LOCAL bool skill_gain_in_progress = FALSE; // whether we are currently in the skill-gain screen
 
-bool save_game_quietly = FALSE; // whether we are currently trying to save the game without displaying a message
+GAME_LOCAL bool save_game_quietly = FALSE; // whether we are currently trying to save the game without displaying a message
 
-bool stop_stealth_mode = FALSE; // whether there has been a signal that we need to abort stealth mode
+GAME_LOCAL bool stop_stealth_mode = FALSE; // whether there has been a signal that we need to abort stealth mode
 
-char mini_screenshot_char[7][7];  // Characters in a mini-screenshot array
-byte mini_screenshot_attr[7][7];  // Colours in a mini-screenshot array
+GAME_LOCAL char mini_screenshot_char[7][7];  // Characters in a mini-screenshot array
+GAME_LOCAL byte mini_screenshot_attr[7][7];  // Colours in a mini-screenshot array
 
 bool use_background_colors = FALSE;
 
@@ -137,19 +150,19 @@ bool use_background_colors = FALSE;
 /*
  * TRUE if process_command() is a repeated call.
  */
-bool command_repeating = FALSE;
+GAME_LOCAL bool command_repeating = FALSE;
 
 
 /*
  * Dungeon variables
  */
 
-byte feeling;			/* Most recent feeling */
-s16b rating;			/* Level's current rating */
+GAME_LOCAL byte feeling;			/* Most recent feeling */
+GAME_LOCAL s16b rating;			/* Level's current rating */
 
-bool good_item_flag;	/* True if "Artefact" on this level */
+GAME_LOCAL bool good_item_flag;	/* True if "Artefact" on this level */
 
-bool closing_flag;		/* Dungeon is closing */
+GAME_LOCAL bool closing_flag;		/* Dungeon is closing */
 
 
 /*
@@ -163,7 +176,7 @@ int player_egid;
 /*
  * Buffer to hold the current savefile name
  */
-char savefile[1024];
+GAME_LOCAL char savefile[1024];
 
 
 /*
@@ -185,7 +198,7 @@ cptr *macro__act;
 /*
  * The array[ANGBAND_TERM_MAX] of window pointers
  */
-term *angband_term[ANGBAND_TERM_MAX];
+GAME_LOCAL term *angband_term[ANGBAND_TERM_MAX];
 
 
 /*
@@ -296,18 +309,18 @@ const cptr angband_sound_name[SOUND_MAX] =
 /*
  * Array[VIEW_MAX] used by "update_view()"
  */
-int view_n = 0;
-u16b *view_g;
+GAME_LOCAL int view_n = 0;
+GAME_LOCAL u16b *view_g;
 
 /*
  * Arrays[TEMP_MAX] used for various things
  *
  * Note that temp_g shares memory with temp_x and temp_y.
  */
-int temp_n = 0;
-u16b *temp_g;
-byte *temp_y;
-byte *temp_x;
+GAME_LOCAL int temp_n = 0;
+GAME_LOCAL u16b *temp_g;
+GAME_LOCAL byte *temp_y;
+GAME_LOCAL byte *temp_x;
 
 
 /*
@@ -316,17 +329,17 @@ byte *temp_x;
  * This array is padded to a width of 256 to allow fast access to elements
  * in the array via "grid" values (see the GRID() macros).
  */
-u16b (*cave_info)[256];
+GAME_LOCAL u16b (*cave_info)[256];
 
 /*
  * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid feature codes
  */
-byte (*cave_feat)[MAX_DUNGEON_WID];
+GAME_LOCAL byte (*cave_feat)[MAX_DUNGEON_WID];
 
 /*
  * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid light level
  */
-s16b (*cave_light)[MAX_DUNGEON_WID];
+GAME_LOCAL s16b (*cave_light)[MAX_DUNGEON_WID];
 
 
 /*
@@ -340,7 +353,7 @@ s16b (*cave_light)[MAX_DUNGEON_WID];
  * any object is in a grid, and relatively fast determination of which objects
  * are in a grid.
  */
-s16b (*cave_o_idx)[MAX_DUNGEON_WID];
+GAME_LOCAL s16b (*cave_o_idx)[MAX_DUNGEON_WID];
 
 /*
  * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid monster indexes
@@ -352,7 +365,7 @@ s16b (*cave_o_idx)[MAX_DUNGEON_WID];
  * the player structure, but provides extremely fast determination of which,
  * if any, monster or player is in any given grid.
  */
-s16b (*cave_m_idx)[MAX_DUNGEON_WID];
+GAME_LOCAL s16b (*cave_m_idx)[MAX_DUNGEON_WID];
 
 /*
  * Table of avergae monster power.
@@ -363,101 +376,134 @@ u32b mon_power_ave[MAX_DEPTH][CREATURE_TYPE_MAX];
 
 
 /*
- * Arrays[NUM_FLOWS][DUNGEON_HGT][DUNGEON_WID] of cave grid flow "cost" values
+ * Arrays[DUNGEON_HGT][DUNGEON_WID] of cave grid flow "cost" values for each flow
+ * (NULL for flows that haven't been built, see flow_fill())
  */
-byte cave_cost[MAX_FLOWS][MAX_DUNGEON_HGT][MAX_DUNGEON_WID];
+GAME_LOCAL byte_wid *cave_cost[MAX_FLOWS];
+
+/*
+ * Movement classes for the flows shared by alert monsters
+ */
+GAME_LOCAL flow_class_type flow_class[MAX_FLOW_CLASSES];
+
+/*
+ * Counts changes to the terrain, so flows can tell if they are out of date
+ */
+GAME_LOCAL u32b terrain_epoch = 0;
+
+/*
+ * The most recent changes to the terrain (indexed by terrain_epoch % FLOW_DIRTY_MAX)
+ */
+GAME_LOCAL byte flow_dirty_y[FLOW_DIRTY_MAX];
+GAME_LOCAL byte flow_dirty_x[FLOW_DIRTY_MAX];
+
+/*
+ * The terrain epoch each flow was last brought up to date with
+ */
+GAME_LOCAL u32b flow_epoch[MAX_FLOWS];
 
 /*
  * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid flow "when" stamps
  */
-byte (*cave_when)[MAX_DUNGEON_WID];
+GAME_LOCAL byte (*cave_when)[MAX_DUNGEON_WID];
 
 /*
  * Current scent age marker.  Counts down from 250 to 0 and then loops.
  */
-int scent_when = 250;
+GAME_LOCAL int scent_when = 250;
 
 
 /*
  * Centerpoints of the last flow (noise) rebuild and the last flow update.
  */
-byte flow_center_y[MAX_FLOWS];
-byte flow_center_x[MAX_FLOWS];
-byte update_center_y[MAX_FLOWS];
-byte update_center_x[MAX_FLOWS];
+GAME_LOCAL byte flow_center_y[MAX_FLOWS];
+GAME_LOCAL byte flow_center_x[MAX_FLOWS];
+GAME_LOCAL byte update_center_y[MAX_FLOWS];
+GAME_LOCAL byte update_center_x[MAX_FLOWS];
 
 /*
  * Wandering monsters will often pause at their destination for a while
  */
-s16b wandering_pause[MAX_FLOWS];
+GAME_LOCAL s16b wandering_pause[MAX_FLOWS];
 
 
 /*
  * Represents the modified stealth_score for the player this round.
  */
-s16b stealth_score = 0;
+GAME_LOCAL s16b stealth_score = 0;
 
 /*
  * Has the player attacked anyone this round? Has anyone attacked the player?
  */
-bool player_attacked = FALSE;
-bool attacked_player = FALSE;
+GAME_LOCAL bool player_attacked = FALSE;
+GAME_LOCAL bool attacked_player = FALSE;
 
 
 /*
  * Array[z_info->o_max] of dungeon objects
  */
-object_type *o_list;
+GAME_LOCAL object_type *o_list;
 
 /*
  * Array[MAX_MONSTERS] of dungeon monsters
  */
-monster_type *mon_list;
+GAME_LOCAL monster_type *mon_list;
 
 
 /*
  * Array[z_info->r_max] of monster lore
  */
-monster_lore *l_list;
+GAME_LOCAL monster_lore *l_list;
 
 
 /*
  * Array[INVEN_TOTAL] of objects in the player's inventory
  */
-object_type *inventory;
+GAME_LOCAL object_type *inventory;
 
 
 /*
  * The size of "alloc_kind_table" (at most z_info->k_max * 4)
  */
-s16b alloc_kind_size;
+GAME_LOCAL s16b alloc_kind_size;
 
 /*
  * The array[alloc_kind_size] of entries in the "kind allocator table"
  */
-alloc_entry *alloc_kind_table;
+GAME_LOCAL alloc_entry *alloc_kind_table;
+
+/*
+ * Changed whenever "alloc_kind_table" is restricted (see "get_obj_num()")
+ */
+GAME_LOCAL u32b alloc_kind_version;
 
 
 /*
  * The size of the "alloc_ego_table"
  */
-s16b alloc_ego_size;
+GAME_LOCAL s16b alloc_ego_size;
 
 /*
  * The array[alloc_ego_size] of entries in the "ego allocator table"
  */
-alloc_entry *alloc_ego_table;
+GAME_LOCAL alloc_entry *alloc_ego_table;
 
 
 /*
  * The size of "alloc_race_table" (at most z_info->r_max)
  */
-s16b alloc_race_size;
+GAME_LOCAL s16b alloc_race_size;
 
 /*
  * The array[alloc_race_size] of entries in the "race allocator table"
  */
-alloc_entry *alloc_race_table;
+GAME_LOCAL alloc_entry *alloc_race_table;
+
+/*
+ * Changed whenever "alloc_race_table" is restricted, or a race starts or
+ * stops being too prolific to appear (see "get_mon_num()")
+ */
+GAME_LOCAL u32b alloc_race_version;
 
 
 /*
@@ -493,29 +539,19 @@ cptr keymap_act[KEYMAP_MODES][256];
 /*
  * Pointer to the player tables (sex, race, house, magic)
  */
-const player_sex *sp_ptr;
-const player_race *rp_ptr;
-player_house *hp_ptr;
-
-/*
- * The player other record (static)
- */
-static player_other player_other_body;
-
-/*
- * Pointer to the player other record
- */
-player_other *op_ptr = &player_other_body;
+GAME_LOCAL const player_sex *sp_ptr;
+GAME_LOCAL const player_race *rp_ptr;
+GAME_LOCAL player_house *hp_ptr;
 
 /*
- * The player info record (static)
+ * The player other record (see "op_ptr")
  */
-static player_type player_type_body;
+GAME_LOCAL player_other player_other_body;
 
 /*
- * Pointer to the player info record
+ * The player info record (see "p_ptr")
  */
-player_type *p_ptr = &player_type_body;
+GAME_LOCAL player_type player_type_body;
 
 
 /*
@@ -540,9 +576,10 @@ char *f_text;
 /*
  * The object kind arrays
  */
-object_kind *k_info;
+GAME_LOCAL object_kind *k_info;
 char *k_name;
 char *k_text;
+index_table k_index;	/* Finds object kinds by tval and sval */
 
 /*
  * The ability arrays
@@ -554,7 +591,7 @@ char *b_text;
 /*
  * The artefact arrays
  */
-artefact_type *a_info;
+GAME_LOCAL artefact_type *a_info;
 char *a_text;
 
 /*
@@ -565,7 +602,7 @@ names_type *n_info;
 /*
  * The special item arrays
  */
-ego_item_type *e_info;
+GAME_LOCAL ego_item_type *e_info;
 char *e_name;
 char *e_text;
 
@@ -573,7 +610,7 @@ char *e_text;
 /*
  * The monster race arrays
  */
-monster_race *r_info;
+GAME_LOCAL monster_race *r_info;
 char *r_name;
 char *r_text;
 
@@ -609,19 +646,19 @@ char *flavor_text;
 /*
  * The combat roll array for displaying past combat rolls
  */
-combat_roll combat_rolls[2][MAX_COMBAT_ROLLS];
-int combat_number;
-int combat_number_old;
-int turns_since_combat;
-char combat_roll_special_char;
-byte combat_roll_special_attr;
+GAME_LOCAL combat_roll combat_rolls[2][MAX_COMBAT_ROLLS];
+GAME_LOCAL int combat_number;
+GAME_LOCAL int combat_number_old;
+GAME_LOCAL int turns_since_combat;
+GAME_LOCAL char combat_roll_special_char;
+GAME_LOCAL byte combat_roll_special_attr;
 
 /*
  * Hacky variables for ignoring a square during project_path() function
  */
-bool project_path_ignore;
-int project_path_ignore_y;
-int project_path_ignore_x;
+GAME_LOCAL bool project_path_ignore;
+GAME_LOCAL int project_path_ignore_y;
+GAME_LOCAL int project_path_ignore_x;
 
 /*
  * Hack -- The special Angband "System Suffix"
@@ -718,51 +755,51 @@ cptr ANGBAND_DIR_SCRIPT;
  * Total Hack -- allow all items to be listed (even empty ones)
  * This is only used by "do_cmd_inven_e()" and is cleared there.
  */
-bool item_tester_full;
+GAME_LOCAL bool item_tester_full;
 
 
 /*
  * Here is a "pseudo-hook" used during calls to "get_item()" and
  * "show_inven()" and "show_equip()", and the choice window routines.
  */
-byte item_tester_tval;
+GAME_LOCAL byte item_tester_tval;
 
 
 /*
  * Here is a "hook" used during calls to "get_item()" and
  * "show_inven()" and "show_equip()", and the choice window routines.
  */
-bool (*item_tester_hook)(const object_type*);
+GAME_LOCAL bool (*item_tester_hook)(const object_type*);
 
 
 
 /*
  * Current "comp" function for ang_sort()
  */
-bool (*ang_sort_comp)(const void *u, const void *v, int a, int b);
+GAME_LOCAL bool (*ang_sort_comp)(const void *u, const void *v, int a, int b);
 
 
 /*
  * Current "swap" function for ang_sort()
  */
-void (*ang_sort_swap)(void *u, void *v, int a, int b);
+GAME_LOCAL void (*ang_sort_swap)(void *u, void *v, int a, int b);
 
 
 
 /*
  * Hack -- function hook to restrict "get_mon_num_prep()" function
  */
-bool (*get_mon_num_hook)(int r_idx);
+GAME_LOCAL bool (*get_mon_num_hook)(int r_idx);
 
 
 
 /*
  * Hack -- function hook to restrict "get_obj_num_prep()" function
  */
-bool (*get_obj_num_hook)(int k_idx);
+GAME_LOCAL bool (*get_obj_num_hook)(int k_idx);
 
 
-void (*object_info_out_flags)(const object_type *o_ptr, u32b *f1, u32b *f2, u32b *f3);
+GAME_LOCAL void (*object_info_out_flags)(const object_type *o_ptr, u32b *f1, u32b *f2, u32b *f3);
 
 
 /*
@@ -775,20 +812,20 @@ FILE *text_out_file = NULL;
  * Hack -- function hook to output (colored) text to the
  * screen or to a file.
  */
-void (*text_out_hook)(byte a, cptr str);
+GAME_LOCAL void (*text_out_hook)(byte a, cptr str);
 
 
 /*
  * Hack -- Where to wrap the text when using text_out().  Use the default
  * value (for example the screen width) when 'text_out_wrap' is 0.
  */
-int text_out_wrap = 0;
+GAME_LOCAL int text_out_wrap = 0;
 
 
 /*
  * Hack -- Indentation for the text when using text_out().
  */
-int text_out_indent = 0;
+GAME_LOCAL int text_out_indent = 0;
 
 
 /*
@@ -800,49 +837,49 @@ bool use_transparency = FALSE;
 /*
  * Buffer to hold the character's notes
  */
-char notes_buffer[NOTES_LENGTH];
+GAME_LOCAL char notes_buffer[NOTES_LENGTH];
 
 
  /* Two variables that limit rogue stealing and creation of traps.
  * Cleared when a level is created. {From Oangband} -JG
  */
-byte recent_failed_thefts;
-byte num_trap_on_level;
+GAME_LOCAL byte recent_failed_thefts;
+GAME_LOCAL byte num_trap_on_level;
 
 /*occasionally allow chance of different inventory in a store*/
-byte allow_altered_inventory;
+GAME_LOCAL byte allow_altered_inventory;
 
 
-autoinscription* inscriptions = 0;
-u16b inscriptionsCount = 0;
+GAME_LOCAL autoinscription* inscriptions = 0;
+GAME_LOCAL u16b inscriptionsCount = 0;
 
 
 /* The bones file a restored player ghost should use to collect extra
  * flags, a sex, and a unique name.  This also indicates that there is
  * a ghost active.  -LM-
  */
-byte bones_selector;
+GAME_LOCAL byte bones_selector;
 
 /*
  * The player ghost template index. -LM-
  */
-int r_ghost;
+GAME_LOCAL int r_ghost;
 
 /*
  * The player ghost name is stored here for quick reference by the
  * description function.  -LM-
  */
-char ghost_name[80];
+GAME_LOCAL char ghost_name[80];
 
 
 /*
  * The type (if any) of the player ghost's personalized string, and
  * the string itself. -LM-
  */
-int ghost_string_type = 0;
-char ghost_string[80];
+GAME_LOCAL int ghost_string_type = 0;
+GAME_LOCAL char ghost_string[80];
 
 /*
  * The name of the current greater vault, if any. -DG-
  */
-char g_vault_name[80];
+GAME_LOCAL char g_vault_name[80];
@@ -140,7 +140,7 @@ void display_noise_map(void)
                 if (m_ptr->alertness < ALERTNESS_ALERT)     dist = flow_dist(m_ptr->wandering_idx, y, x);
                 
                 // otherwise, use its distance in turns to the player
-                else                                        dist = flow_dist(p_ptr->health_who, y, x);
+                else                                        dist = flow_dist(m_ptr->flow, y, x);
             }
 
             if (dist <= 0) continue;
@@ -1584,6 +1584,38 @@ void do_cmd_wiz_look(void)
 }
 
 
+#ifdef ALLOW_PROFILE
+
+/*
+ * Show the profiler's report of where the time has gone
+ */
+static void do_cmd_wiz_profile(void)
+{
+	FILE *fff;
+
+	char file_name[1024];
+
+	/* Temporary file */
+	fff = my_fopen_temp(file_name, sizeof(file_name));
+
+	/* Failure */
+	if (!fff) return;
+
+	profile_report(fff);
+
+	/* Close the file */
+	my_fclose(fff);
+
+	/* Display the file contents */
+	show_file(file_name, "Profile", 0);
+
+	/* Remove the file */
+	fd_kill(file_name);
+}
+
+#endif /* ALLOW_PROFILE */
+
+
 /*
  * Ask for and parse a "debug command"
  *
@@ -1755,6 +1787,17 @@ void do_cmd_debug(void)
 			break;
 		}
 
+#ifdef ALLOW_PROFILE
+
+		/* Profiler report */
+		case 'P':
+		{
+			do_cmd_wiz_profile();
+			break;
+		}
+
+#endif
+
 		/* Query the dungeon */
 		case 'q':
 		{
@@ -3099,6 +3099,8 @@ void redraw_stuff(void)
 	/* Character is in "icky" mode, no screen updates */
 	if (character_icky && !p_ptr->is_dead) return;
 
+	PROFILE_START(PROF_REDRAW_STUFF);
+
 	if (p_ptr->redraw & (PR_MAP))
 	{
 		p_ptr->redraw &= ~(PR_MAP);
@@ -3272,6 +3274,8 @@ void redraw_stuff(void)
 		p_ptr->redraw &= ~(PR_TERRAIN);
         prt_terrain();
 	}
+
+	PROFILE_STOP(PROF_REDRAW_STUFF);
 }
 
 
@@ -3305,6 +3309,8 @@ void window_stuff(void)
 	/* Nothing to do */
 	if (!p_ptr->window) return;
 
+	PROFILE_START(PROF_WINDOW_STUFF);
+
 
 	/* Display inventory */
 	if (p_ptr->window & (PW_INVEN))
@@ -3355,6 +3361,7 @@ void window_stuff(void)
 		fix_monster();
 	}
 
+	PROFILE_STOP(PROF_WINDOW_STUFF);
 }
 
 
@@ -1726,7 +1726,7 @@ extern void break_truce(bool obvious)
 			if (!m_ptr->r_idx) continue;
 			
 			// Ignore monsters out of line of sight
-			if (!los(m_ptr->fy, m_ptr->fx, p_ptr->py, p_ptr->px)) continue;
+			if (!los_to_player(m_ptr->fy, m_ptr->fx)) continue;
 			
 			// Ignore unalert monsters
 			if (m_ptr->alertness < ALERTNESS_ALERT) continue;
@@ -2211,6 +2211,7 @@ void monster_death(int m_idx)
     if (r_ptr->flags1 & (RF1_UNIQUE))
     {
         r_ptr->max_num = 0;
+        alloc_race_version++;
     }
     
     /* Count kills this life */
@@ -5104,6 +5105,9 @@ void pause_with_text(const char desc[][100], int row, int col)
 	int j = 0;
 	int msec = 50;
 	
+	/* Nobody is watching a batch game */
+	if (arg_batch) return;
+
 	/* Save screen */
 	screen_save();
 	
@@ -593,8 +593,8 @@ void strnfcat(char *str, size_t max, size_t *end, cptr fmt, ...)
 
 
 
-static char *format_buf = NULL;
-static size_t format_len = 0;
+static GAME_LOCAL char *format_buf = NULL;
+static GAME_LOCAL size_t format_len = 0;
 
 
 /*
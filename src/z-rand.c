@@ -14,8 +14,9 @@
  *
  *
  * This code provides both a "quick" random number generator (4 bytes of
- * state), and a "decent" random number generator (256 bytes of state),
- * both available in two flavors, first, the simple "mod" flavor, which
+ * state), and a "decent" random number generator (16 bytes of state for
+ * each of several streams), both available in two flavors, first, the
+ * simple "mod" flavor, which
  * is fast, but slightly biased at high values, and second, the simple
  * "div" flavor, which is less fast (and potentially non-terminating)
  * but which is not biased and is much less subject to non-randomness
@@ -29,9 +30,12 @@
  * seed via "Rand_value = seed".
  *
  *
- * This (optimized) random number generator is based loosely on the old
- * "random.c" file from Berkeley but with some major optimizations and
- * algorithm changes.  See below for more details.
+ * The "complex" RNG is "xoshiro128**" by David Blackman and Sebastiano
+ * Vigna.  It is fast and has a period of 2^128 - 1, and it can be "jumped"
+ * ahead by 2^64 numbers at the cost of generating 128 of them, which is
+ * how the streams are kept apart: each one starts 2^64 numbers after the
+ * previous one, so they can never overlap in a game.  Choose a stream by
+ * setting "Rand_stream" (and put it back afterwards).
  *
  * Some code by Ben Harrison (benh@phial.com).
  *
@@ -53,52 +57,139 @@
 /*
  * Use the "simple" LCRNG
  */
-bool Rand_quick = TRUE;
+GAME_LOCAL bool Rand_quick = TRUE;
 
 
 /*
  * Current "value" of the "simple" RNG
  */
-u32b Rand_value;
+GAME_LOCAL u32b Rand_value;
 
 
 /*
- * Current "index" for the "complex" RNG
+ * Current stream for the "complex" RNG
  */
-u16b Rand_place;
+GAME_LOCAL u16b Rand_stream;
 
 /*
- * Current "state" table for the "complex" RNG
+ * Current "state" of each stream of the "complex" RNG
  */
-u32b Rand_state[RAND_DEG];
+GAME_LOCAL u32b Rand_state[RAND_STREAMS][RAND_WORDS];
 
 
+/*
+ * Hack -- keep the low 32 bits (a "u32b" may be wider than that)
+ */
+#define LOW32(X)	((X) & 0xFFFFFFFFUL)
+
+/*
+ * Rotate a 32 bit value left
+ */
+#define ROTL(X,K)	LOW32(((X) << (K)) | ((X) >> (32 - (K))))
+
+
+/*
+ * Extract the next number from a stream of the "complex" RNG
+ */
+static u32b Rand_next(u32b *s)
+{
+	u32b r = LOW32(ROTL(LOW32(s[1] * 5), 7) * 9);
+	u32b t = LOW32(s[1] << 9);
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+
+	s[2] ^= t;
+
+	s[3] = ROTL(s[3], 11);
+
+	return (r);
+}
+
+
+/*
+ * Advance a stream of the "complex" RNG by 2^64 numbers
+ */
+static void Rand_jump(u32b *s)
+{
+	static const u32b jump[RAND_WORDS] =
+	{
+		0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b
+	};
+
+	u32b t[RAND_WORDS] = { 0, 0, 0, 0 };
+	int i, b, j;
+
+	for (i = 0; i < RAND_WORDS; i++)
+	{
+		for (b = 0; b < 32; b++)
+		{
+			if (jump[i] & (1UL << b))
+			{
+				for (j = 0; j < RAND_WORDS; j++) t[j] ^= s[j];
+			}
+
+			(void)Rand_next(s);
+		}
+	}
+
+	for (j = 0; j < RAND_WORDS; j++) s[j] = t[j];
+}
+
 
 /*
  * Initialize the "complex" RNG using a new seed
+ *
+ * The seed is spread over the first stream, and each of the others
+ * starts where the one before it would reach after 2^64 numbers.
  */
 void Rand_state_init(u32b seed)
 {
 	int i, j;
 
-	/* Seed the table */
-	Rand_state[0] = seed;
+	/* Spread the seed out (the state must never be all zero) */
+	for (j = 0; j < RAND_WORDS; j++)
+	{
+		u32b z = (seed = LOW32(seed + 0x9E3779B9));
+
+		z = LOW32((z ^ (z >> 16)) * 0x85EBCA6B);
+		z = LOW32((z ^ (z >> 13)) * 0xC2B2AE35);
+		z = z ^ (z >> 16);
 
-	/* Propagate the seed */
-	for (i = 1; i < RAND_DEG; i++) Rand_state[i] = LCRNG(Rand_state[i-1]);
+		Rand_state[0][j] = z ? z : 1;
+	}
 
-	/* Cycle the table ten times per degree */
-	for (i = 0; i < RAND_DEG * 10; i++)
+	/* Place the other streams */
+	for (i = 1; i < RAND_STREAMS; i++)
 	{
-		/* Acquire the next index */
-		j = Rand_place + 1;
-		if (j == RAND_DEG) j = 0;
+		for (j = 0; j < RAND_WORDS; j++) Rand_state[i][j] = Rand_state[i-1][j];
+
+		Rand_jump(Rand_state[i]);
+	}
+
+	/* Start with the general stream */
+	Rand_stream = RAND_STREAM_MISC;
+}
 
-		/* Update the table, extract an entry */
-		Rand_state[j] += Rand_state[Rand_place];
 
-		/* Advance the index */
-		Rand_place = j;
+/*
+ * Split a new stream off an existing one
+ *
+ * The new stream is seeded from the next numbers of the old one, so it is
+ * always the same for the same old stream, however much of it is then used.
+ */
+void Rand_split(u32b *from, u32b *to)
+{
+	int j;
+
+	for (j = 0; j < RAND_WORDS; j++)
+	{
+		u32b z = Rand_next(from);
+
+		/* The state must never be all zero */
+		to[j] = z ? z : 1;
 	}
 }
 
@@ -149,24 +240,17 @@ u32b Rand_div(u32b m)
 	/* Use a complex RNG */
 	else
 	{
+		u32b *s = Rand_state[Rand_stream];
+
 		/* Wait for it */
 		while (1)
 		{
-			int j;
-
-			/* Acquire the next index */
-			j = Rand_place + 1;
-			if (j == RAND_DEG) j = 0;
-
-			/* Update the table, extract an entry */
-			r = (Rand_state[j] += Rand_state[Rand_place]);
+			/* Cycle the generator */
+			r = Rand_next(s);
 
 			/* Hack -- extract a 28-bit "random" number */
 			r = ((r >> 4) & 0x0FFFFFFF) / n;
 
-			/* Advance the index */
-			Rand_place = j;
-
 			/* Done */
 			if (r < m) break;
 		}
@@ -306,8 +390,8 @@ s16b Rand_normal(int mean, int stand)
  */
 u32b Rand_simple(u32b m)
 {
-	static bool initialized = FALSE;
-	static u32b simple_rand_value;
+	static GAME_LOCAL bool initialized = FALSE;
+	static GAME_LOCAL u32b simple_rand_value;
 	bool old_rand_quick;
 	u32b old_rand_value;
 	u32b result;
@@ -19,11 +19,31 @@
 
 
 /*
- * The "degree" of the "complex" Random Number Generator.
+ * The number of words of "complex" RNG state kept in the savefile.
  * This value is hard-coded at 63 for a wide variety of reasons.
  */
 #define RAND_DEG 63
 
+/*
+ * The independent streams of the "complex" RNG.
+ *
+ * Each part of the game that makes random choices draws from its own
+ * stream (see "Rand_stream"), so that a change in how many numbers one
+ * part uses does not change what happens in the others.
+ */
+#define RAND_STREAM_MISC		0	/* Everything else (mostly the player) */
+#define RAND_STREAM_LEVEL		1	/* Level generation */
+#define RAND_STREAM_MONSTER		2	/* Monster AI */
+#define RAND_STREAM_COMBAT		3	/* Combat rolls */
+#define RAND_STREAM_OBJECT		4	/* Object generation */
+#define RAND_STREAM_AUTOMATON	5	/* The automaton */
+#define RAND_STREAMS			6
+
+/*
+ * The number of words of state in each stream
+ */
+#define RAND_WORDS 4
+
 
 
 /**** Available macros ****/
@@ -88,16 +108,17 @@
 
 /**** Available Variables ****/
 
-extern bool Rand_quick;
-extern u32b Rand_value;
-extern u16b Rand_place;
-extern u32b Rand_state[RAND_DEG];
+extern GAME_LOCAL bool Rand_quick;
+extern GAME_LOCAL u32b Rand_value;
+extern GAME_LOCAL u16b Rand_stream;
+extern GAME_LOCAL u32b Rand_state[RAND_STREAMS][RAND_WORDS];
 
 
 /**** Available Functions ****/
 
 
 extern void Rand_state_init(u32b seed);
+extern void Rand_split(u32b *from, u32b *to);
 extern u32b Rand_div(u32b m);
 extern s16b Rand_normal(int mean, int stand);
 extern u32b Rand_simple(u32b m);
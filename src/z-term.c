@@ -275,7 +275,7 @@
 /*
  * The current "term"
  */
-term *Term = NULL;
+GAME_LOCAL term *Term = NULL;
 
 
 
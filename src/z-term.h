@@ -269,7 +269,7 @@ struct term
 
 /**** Available Variables ****/
 
-extern term *Term;
+extern GAME_LOCAL term *Term;
 
 /**** Available Functions ****/
 
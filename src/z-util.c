@@ -260,3 +260,124 @@ void core(cptr str)
 
 
 
+
+
+
+/*
+ * Hack -- keep the low 32 bits (a "u32b" may be wider than that)
+ */
+#define LOW32(X)	((X) & 0xFFFFFFFFUL)
+
+
+/*
+ * Hash a string (FNV-1a)
+ */
+u32b hash_string(cptr s)
+{
+	u32b h = 2166136261UL;
+
+	while (*s)
+	{
+		h = LOW32((h ^ (byte)*s++) * 16777619UL);
+	}
+
+	return (h);
+}
+
+
+/*
+ * Hash a block of memory
+ *
+ * This is FNV-1a taken four bytes at a time, in four interleaved lanes so
+ * that the multiplications can overlap, which makes it several times faster
+ * than hashing byte by byte on large blocks (such as the data cache).
+ */
+u32b hash_bytes(const void *p, size_t n)
+{
+	const byte *b = p;
+	u32b h[4] = { 2166136261UL, 2166136261UL, 2166136261UL, 2166136261UL };
+	int i;
+
+	/* Whole blocks of sixteen bytes */
+	for (; n >= 16; n -= 16, b += 16)
+	{
+		for (i = 0; i < 4; i++)
+		{
+			u32b w = b[4 * i] | (b[4 * i + 1] << 8) |
+			         (b[4 * i + 2] << 16) | ((u32b)b[4 * i + 3] << 24);
+
+			h[i] = LOW32((h[i] ^ w) * 16777619UL);
+		}
+	}
+
+	/* The last few bytes */
+	while (n--)
+	{
+		h[0] = LOW32((h[0] ^ *b++) * 16777619UL);
+	}
+
+	/* Combine the lanes */
+	return (hash_number(h[0] ^ hash_number(h[1] ^ hash_number(h[2] ^ hash_number(h[3])))));
+}
+
+
+/*
+ * Hash a number (the "finalizer" of MurmurHash3)
+ */
+u32b hash_number(u32b n)
+{
+	n = LOW32(n);
+
+	n = LOW32((n ^ (n >> 16)) * 0x85EBCA6BUL);
+	n = LOW32((n ^ (n >> 13)) * 0xC2B2AE35UL);
+
+	return (n ^ (n >> 16));
+}
+
+
+/*
+ * The number of slots an index table needs to hold "n" numbers
+ * (a power of two, with at least half of them always empty)
+ */
+u32b index_table_size(int n)
+{
+	u32b size = 16;
+
+	while (size < 2 * (u32b)n) size *= 2;
+
+	return (size);
+}
+
+
+/*
+ * Add the number "n" (from 0 to 65534) with the given hash to an index table
+ */
+void index_table_add(index_table *t, u32b hash, int n)
+{
+	u32b i = hash & (t->size - 1);
+
+	/* Find an empty slot */
+	while (t->slot[i]) i = (i + 1) & (t->size - 1);
+
+	t->slot[i] = (u16b)(n + 1);
+}
+
+
+/*
+ * Find the next number in an index table which might have the given hash,
+ * or -1 if there are no more.
+ *
+ * "*probe" must be zero for the first call, and is then left alone until the
+ * search is done.
+ */
+int index_table_find(const index_table *t, u32b hash, u32b *probe)
+{
+	u32b i = (hash + *probe) & (t->size - 1);
+
+	/* An empty slot ends the search */
+	if (!t->slot[i]) return (-1);
+
+	(*probe)++;
+
+	return (t->slot[i] - 1);
+}
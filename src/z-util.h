@@ -21,6 +21,28 @@
  */
 
 
+/**** Available types ****/
+
+
+/*
+ * An index table finds numbers (such as indexes into an array) from a hash
+ * of their keys, by open addressing with linear probing.  The table only
+ * knows the hashes, so each number it offers must be checked against the
+ * key, and the next one asked for if it doesn't match.  Numbers with the same
+ * hash are offered in the order they were added.
+ *
+ * The slots belong to whoever uses the table: "size" of them (see
+ * "index_table_size()"), all zero to begin with.
+ */
+typedef struct index_table index_table;
+
+struct index_table
+{
+	u16b *slot;		/* Each number plus one, or zero for an empty slot */
+	u32b size;		/* The number of slots (a power of two) */
+};
+
+
 /**** Available variables ****/
 
 /* A cptr to the name of the program */
@@ -60,6 +82,16 @@ extern void quit(cptr str);
 /* Dump core, with optional message */
 extern void core(cptr str);
 
+/* Hash a string, a block of memory or a number */
+extern u32b hash_string(cptr s);
+extern u32b hash_bytes(const void *p, size_t n);
+extern u32b hash_number(u32b n);
+
+/* Index tables */
+extern u32b index_table_size(int n);
+extern void index_table_add(index_table *t, u32b hash, int n);
+extern int index_table_find(const index_table *t, u32b hash, u32b *probe);
+
 
 
 #endif